@@ -0,0 +1,88 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IBOTHOST_HPP
+#define IBOTHOST_HPP
+
+#include <memory>
+#include <string>
+#include <stdint.h>
+#include <config.h>
+#include <IDiscordClient.hpp>
+
+namespace DiscordBot
+{
+    class IBotHost;
+    using BotHost = std::shared_ptr<IBotHost>;
+
+    /**
+     * @brief Runs several bots inside one process.
+     * 
+     * All clients of a host share one thread pool, one timer service and one http client, and users which are seen by several bots are cached once.
+     * Only the websocket connections of the shards and the voice playback use own threads.
+     */
+    class DISCORDBOT_EXPORT IBotHost
+    {
+        public:
+            IBotHost(/* args */) {}
+
+            /**
+             * @brief Creates a client which uses the shared resources of this host.
+             * 
+             * @param Token: Your Discord bot token.
+             * 
+             * @note The client is started by Run() of the host. Don't call Run() or Start() of the client.
+             */
+            virtual DiscordClient AddClient(const std::string &Token, Intent Intents = Intent::DEFAULTS) = 0;
+
+            /**
+             * @brief Connects all clients. The call returns if all clients have quit. @see Quit()
+             */
+            virtual void Run() = 0;
+
+            /**
+             * @brief Quits all clients.
+             */
+            virtual void Quit() = 0;
+
+            /**
+             * @return Gets the shared user cache of all clients.
+             */
+            virtual Users GetUsers() = 0;
+
+            /**
+             * @param WorkerCount: Count of threads which process the events of all clients. 0 uses the count of cpu cores.
+             * 
+             * @note The controllers must be thread safe, because the callbacks of different guilds run in parallel.
+             * 
+             * @return Returns a new host object.
+             */
+            static BotHost Create(uint32_t WorkerCount = 0);
+
+            virtual ~IBotHost() {}
+    };
+} // namespace DiscordBot
+
+
+#endif //IBOTHOST_HPP
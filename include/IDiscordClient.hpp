@@ -26,6 +26,7 @@
 #define IDISCORDCLIENT_HPP
 
 #include <memory>
+#include <functional>
 #include <controller/IController.hpp>
 #include <controller/IAudioSource.hpp>
 #include <models/Embed.hpp>
@@ -41,6 +42,7 @@ namespace DiscordBot
     using DiscordClient = std::shared_ptr<IDiscordClient>;
     using Users = std::map<std::string, User>;
     using Guilds = std::map<std::string, Guild>;
+    using RawEventHandler = std::function<void(uint32_t ShardID, const std::string &Data)>;
 
     //Discord Gateway intents https://discordapp.com/developers/docs/topics/gateway#gateway-intents
     enum class Intent
@@ -124,6 +126,31 @@ namespace DiscordBot
         return static_cast<Intent>(static_cast<unsigned>(lhs) |static_cast<unsigned>(rhs));
     }  
 
+    /**
+     * @brief Encoding of the gateway messages.
+     */
+    enum class GatewayEncoding
+    {
+        JSON,       //!< Default text encoding.
+        ETF         //!< Erlang term format. Binary encoding which is smaller and cheaper to decode.
+    };
+
+    /**
+     * @brief State of one gateway connection.
+     */
+    struct SShardStatus
+    {
+        uint32_t ID;
+        bool Ready;             //!< True if the shard received the READY event.
+        size_t QueueDepth;      //!< Count of commands which are waiting for the rate limit.
+        uint32_t QueueWait;     //!< Wait time of the oldest queued command in milliseconds.
+        uint32_t Tokens;        //!< Commands which can be sent without waiting.
+        uint32_t Latency;       //!< Last heartbeat round trip time in milliseconds.
+        uint32_t AvgLatency;    //!< Smoothed heartbeat round trip time in milliseconds.
+        uint32_t P99Latency;    //!< 99th percentile of the last heartbeat round trip times in milliseconds.
+        bool Standby;           //!< True if the shard belongs to a new shard set which waits for its guilds. @see IDiscordClient::Reshard
+    };
+
     class DISCORDBOT_EXPORT IDiscordClient
     {
         public:
@@ -184,6 +211,18 @@ namespace DiscordBot
              */
             virtual void SetActivity(const std::string &Text, const std::string &URL = "") = 0;
 
+            /**
+             * @brief Starts a presence transaction. Changes of SetState, SetAFK and SetActivity are sent as one update after CommitPresenceUpdate(). @see CommitPresenceUpdate
+             * 
+             * @note Transactions can be nested.
+             */
+            virtual void BeginPresenceUpdate() = 0;
+
+            /**
+             * @brief Finishes a presence transaction and sends the changes.
+             */
+            virtual void CommitPresenceUpdate() = 0;
+
             /**
              * @brief Adds a song to the music queue.
              * 
@@ -289,11 +328,197 @@ namespace DiscordBot
              */
             virtual bool IsPlaying(Guild guild) = 0;
 
+            /**
+             * @brief Enables the "zlib-stream" transport compression of the gateway connection. This reduces the bandwidth, especially for big guilds.
+             * 
+             * @param Compress: True to receive compressed gateway messages.
+             * 
+             * @note Must be called before Run().
+             */
+            virtual void SetCompression(bool Compress) = 0;
+
+            /**
+             * @brief Sets the encoding of the gateway messages.
+             * 
+             * @param Encoding: Encoding which is used for the gateway connection. @see GatewayEncoding
+             * 
+             * @note Must be called before Run().
+             */
+            virtual void SetEncoding(GatewayEncoding Encoding) = 0;
+
+            /**
+             * @brief Sets the count of gateway connections (shards). Each shard receives the events of a subset of guilds. Discord requires sharding for bots with more than 2500 guilds.
+             * 
+             * @param Count: Count of shards or 0 to use the count which is recommended by Discord.
+             * 
+             * @note Must be called before Run().
+             */
+            virtual void SetShardCount(uint32_t Count) = 0;
+
+            /**
+             * @brief Changes the count of shards while the bot is running. A second shard set with the new count connects in parallel and takes over the events, caches and voice connections after it received all its guilds.
+             * 
+             * @param Count: New count of shards.
+             * 
+             * @return Returns false if the bot isn't connected, runs inside a cluster or a resharding is already running.
+             */
+            virtual bool Reshard(uint32_t Count) = 0;
+
+            /**
+             * @brief Runs this bot as part of a shard cluster. The shards of this process are assigned by the coordinator. @see IShardCoordinator
+             * 
+             * @param URL: Websocket url of the coordinator e.g. "ws://127.0.0.1:8540".
+             * 
+             * @note Must be called before Run(). Overrides SetShardCount.
+             */
+            virtual void JoinCluster(const std::string &URL) = 0;
+
+            /**
+             * @return Gets the ids of all guilds of the cluster. Without a cluster only the ids of the local guilds are returned.
+             */
+            virtual std::vector<std::string> GetClusterGuilds() = 0;
+
+            /**
+             * @brief Stores the sessions of all shards periodically and on Quit() in a file. On the next start the shards try to resume these sessions instead of identifying.
+             * 
+             * @param File: Path of the checkpoint file. An empty path disables the checkpoint.
+             * @param Interval: Interval in milliseconds to write the checkpoint.
+             * 
+             * @note Must be called before Run().
+             */
+            virtual void SetSessionCheckpoint(const std::string &File, uint32_t Interval = 5000) = 0;
+
+            /**
+             * @brief Sets the count of threads which process the gateway events. Events of the same guild are processed in order, different guilds in parallel.
+             * 
+             * @param Count: Count of worker threads or 0 to process the events on the websocket thread. The default is 1, so the controller callbacks never run at the same time.
+             * 
+             * @note Must be called before Run(). With more than one worker the callbacks of different guilds run in parallel, so the controller must be thread safe.
+             */
+            virtual void SetWorkerCount(uint32_t Count) = 0;
+
+            /**
+             * @brief Reconnects a shard which doesn't receive any event for the given time. Useful for bots which receive a steady stream of events.
+             * 
+             * @param Timeout: Time in milliseconds or 0 to disable. The default is 0.
+             * 
+             * @note A shard is always reconnected if a heartbeat isn't acknowledged in time.
+             */
+            virtual void SetDispatchTimeout(uint32_t Timeout) = 0;
+
+            /**
+             * @brief Sets the member count at which a guild counts as large. Large guilds only send the online members on join.
+             * 
+             * @param Threshold: Value between 50 and 250. The default is 50.
+             * 
+             * @note Must be called before Run().
+             */
+            virtual void SetLargeThreshold(uint32_t Threshold) = 0;
+
+            /**
+             * @brief Enables the lazy loading of members for large guilds. The members of large guilds aren't loaded on join,
+             *        only the online members of the GUILD_CREATE event are stored. All other members are loaded on demand.
+             * 
+             * @note Use RequestGuildMembers() to load all members of a guild.
+             */
+            virtual void SetLazyMembers(bool Lazy) = 0;
+
+            /**
+             * @brief Registers a handler which receives the undecoded data of a gateway event.
+             * 
+             * @param Event: Name of the event e.g. "MESSAGE_REACTION_ADD".
+             * @param Handler: Called with the shard id and the json "d" field of the event.
+             * 
+             * @note The handler is called on the worker of the guild, before the library processes the event.
+             */
+            virtual void RegisterRawEventHandler(const std::string &Event, RawEventHandler Handler) = 0;
+
+            /**
+             * @return Gets the state of all shards of this process.
+             */
+            virtual std::vector<SShardStatus> GetShardStatus() = 0;
+
+            /**
+             * @brief Loads all members of a guild. The members are loaded in chunks. @see IController::OnGuildMembersChunk
+             * 
+             * @note Needs the GUILD_MEMBERS intent. Members of large guilds are loaded automatically, unless lazy member loading is enabled. @see SetLazyMembers
+             */
+            virtual void RequestGuildMembers(Guild guild) = 0;
+
             /**
              * @brief Runs the bot. The call returns if you calls Quit(). @see Quit()
              */
             virtual void Run() = 0;
 
+            /**
+             * @brief Connects the bot without blocking, for hosts with their own event loop.
+             * 
+             * The controller callbacks are queued and executed on the thread which calls Poll() or RunOnce().
+             * The sockets, timers and the voice playback still use internal threads.
+             * 
+             * @return Returns false if the gateway couldn't be requested.
+             * 
+             * @note Use this instead of Run(). The worker count is ignored. @see GetEventFD
+             */
+            virtual bool Start() = 0;
+
+            /**
+             * @return Gets a fd which becomes readable if RunOnce() has work to do, e.g. to add it to an epoll set. Returns -1 on Windows.
+             */
+            virtual int GetEventFD() = 0;
+
+            /**
+             * @brief Waits for queued events and executes them.
+             * 
+             * @param Timeout: Timeout in milliseconds. A negative timeout waits until an event is queued.
+             * 
+             * @return Returns false if the bot has quit.
+             */
+            virtual bool Poll(int32_t Timeout) = 0;
+
+            /**
+             * @brief Executes all queued events without waiting.
+             * 
+             * @return Returns false if the bot has quit.
+             */
+            virtual bool RunOnce() = 0;
+
+            /**
+             * @brief Records all received gateway frames to a file, which can be passed to Replay().
+             * 
+             * @note Must be called before Run().
+             */
+            virtual void SetTrafficRecorder(const std::string &File) = 0;
+
+            /**
+             * @brief Sets the url of the REST api. Used to test the bot against a local server.
+             * 
+             * @param URL: Url without a trailing slash. The default is "https://discord.com/api".
+             * 
+             * @note Must be called before Run().
+             */
+            virtual void SetBaseURL(const std::string &URL) = 0;
+
+            /**
+             * @brief Overrides the gateway url which is returned by "/gateway/bot". Used to test the bot against a local server.
+             * 
+             * @param URL: Url without query parameters e.g. "ws://127.0.0.1:8080". An empty url uses the returned url.
+             * 
+             * @note Must be called before Run().
+             */
+            virtual void SetGatewayURL(const std::string &URL) = 0;
+
+            /**
+             * @brief Feeds a file of the traffic recorder into this client, without a network connection. Use this instead of Run() to profile or benchmark the event processing.
+             * 
+             * @param File: File which was written by the traffic recorder. @see SetTrafficRecorder
+             * @param RealTime: True to replay with the recorded timing, false to replay as fast as possible.
+             * 
+             * @note Returns after all events are processed. The client sends nothing to the gateway, REST requests are still executed.
+             * @note The compression and the encoding of the recording are used, SetCompression() and SetEncoding() are ignored.
+             */
+            virtual void Replay(const std::string &File, bool RealTime = false) = 0;
+
             /**
              * @brief Quits the bot. And disconnects all voice states.
              */
@@ -304,6 +529,22 @@ namespace DiscordBot
              */
             virtual void QuitAsync() = 0;
 
+            /**
+             * @brief Quits the bot without ending the sessions, so a new process can take over without downtime.
+             * 
+             * The shards stop receiving events, all queued events are processed and the sessions, the guild caches, the voice channels and the music queues are written to the session checkpoint.
+             * The next process which uses the same checkpoint file resumes the sessions, restores the caches and joins the voice channels again. The interrupted songs are played again from the start.
+             * 
+             * @note Needs a session checkpoint file. @see SetSessionCheckpoint
+             * @note Must not be called from a controller callback, use HandoffAsync() instead.
+             */
+            virtual void Handoff() = 0;
+
+            /**
+             * @brief Same as Handoff() but as asynchronous call. @see Handoff()
+             */
+            virtual void HandoffAsync() = 0;
+
             /**
              * @return Gets the bot user.
              */
@@ -0,0 +1,75 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ISHARDCOORDINATOR_HPP
+#define ISHARDCOORDINATOR_HPP
+
+#include <memory>
+#include <string>
+#include <stdint.h>
+#include <config.h>
+
+namespace DiscordBot
+{
+    class IShardCoordinator;
+    using ShardCoordinator = std::shared_ptr<IShardCoordinator>;
+
+    /**
+     * @brief Coordinates the shards of a bot which runs inside multiple processes.
+     * 
+     * The coordinator assigns the shard ranges to the processes, controls the identify concurrency window and relays queries between the processes.
+     * A process joins the cluster via IDiscordClient::JoinCluster.
+     */
+    class DISCORDBOT_EXPORT IShardCoordinator
+    {
+        public:
+            IShardCoordinator(/* args */) {}
+
+            /**
+             * @brief Runs the coordinator. The call returns if you calls Quit(). @see Quit()
+             */
+            virtual void Run() = 0;
+
+            /**
+             * @brief Stops the coordinator.
+             */
+            virtual void Quit() = 0;
+
+            /**
+             * @param TotalShards: Total count of shards of the bot.
+             * @param Processes: Count of processes which share the shards.
+             * @param MaxConcurrency: Count of shards which can identify at the same time. See "max_concurrency" of the session start limit object.
+             * @param Port: Port of the coordinator.
+             * @param Host: Interface to listen on.
+             * 
+             * @return Returns a new coordinator object.
+             */
+            static ShardCoordinator Create(uint32_t TotalShards, uint32_t Processes, uint32_t MaxConcurrency = 1, int Port = 8540, const std::string &Host = "127.0.0.1");
+
+            virtual ~IShardCoordinator() {}
+    };
+} // namespace DiscordBot
+
+
+#endif //ISHARDCOORDINATOR_HPP
@@ -61,16 +61,51 @@ namespace DiscordBot
         AccessMode Mode;            //!< Access mode for this command. This is the default mode for a new server. The owner can access all commands. @see AccessMode
     };
 
+    /**
+     * @brief Optional events of a controller. Events without subscription aren't decoded by the client. @see IController::GetSubscriptions
+     */
+    enum class EventSubscription : uint32_t
+    {
+        NONE = 0,
+        PRESENCE_UPDATE = 1,        //!< OnPresenceUpdate, also updates the presence of the users.
+        USER_PRESENCE = 2,          //!< Updates the online state and activities of the users without calling OnPresenceUpdate.
+        MESSAGE_EDITED = 4,         //!< OnMessageEdited
+        MESSAGE_DELETED = 8,        //!< OnMessageDeleted, OnMessagesDeleted
+
+        ALL = 0xFFFFFFFF
+    };
+
+    inline EventSubscription operator| (EventSubscription lhs, EventSubscription rhs)  
+    {
+        return static_cast<EventSubscription>(static_cast<unsigned>(lhs) | static_cast<unsigned>(rhs));
+    }  
+
+    inline EventSubscription operator& (EventSubscription lhs, EventSubscription rhs)  
+    {
+        return static_cast<EventSubscription>(static_cast<unsigned>(lhs) & static_cast<unsigned>(rhs));
+    }  
+
     /**
      * @brief Controller interface which receives events from the client.
      * 
-     * @note All callbacks can called from different threads.
+     * @note All callbacks can called from different threads. The callbacks of one guild are called in order.
+     *       With more than one event worker the callbacks of different guilds are called at the same time. @see IDiscordClient::SetWorkerCount
      */
     class DISCORDBOT_EXPORT IController
     {
         public:
             IController(IDiscordClient *client);
 
+            /**
+             * @brief Override this to skip the decoding of events which your controller doesn't use. The default subscribes to all events.
+             * 
+             * @return Returns the optional events which this controller uses. @see EventSubscription
+             */
+            virtual EventSubscription GetSubscriptions() const
+            {
+                return EventSubscription::ALL;
+            }
+
             /**
              * @brief Called if the handshake with discord is finished.
              */
@@ -116,6 +151,26 @@ namespace DiscordBot
              */
             virtual void OnMemberRemove(Guild guild, GuildMember Member) {}
 
+            /**
+             * @brief Called for each received chunk of members of a guild. @see IDiscordClient::RequestGuildMembers
+             * 
+             * @param guild: Guild which receives the members.
+             * @param Received: Count of received chunks.
+             * @param Total: Total count of chunks.
+             * 
+             * @note The GUILD_MEMBERS intent needs to be set to receive this event.
+             */
+            virtual void OnGuildMembersChunk(Guild guild, uint32_t Received, uint32_t Total) {}
+
+            /**
+             * @brief Called if all members of a guild are loaded.
+             * 
+             * @param guild: Guild which members are loaded.
+             * 
+             * @note The GUILD_MEMBERS intent needs to be set to receive this event.
+             */
+            virtual void OnGuildMembersLoaded(Guild guild) {}
+
             /**
              * @brief Called if a user changes his activity state or online state.
              * 
@@ -126,6 +181,14 @@ namespace DiscordBot
              */
             virtual void OnPresenceUpdate(Guild guild, GuildMember Member) {}
 
+            /**
+             * @brief Called if a member which wasn't cached is loaded in the background, e.g. the owner of a guild or the author of a message. CGuild::Owner is set before this call.
+             * 
+             * @param guild: Guild of the member.
+             * @param Member: Loaded member.
+             */
+            virtual void OnMemberResolved(Guild guild, GuildMember Member) {}
+
             /**
              * @brief Called if a new message was sended. Process the message and call associated commands.
              * 
@@ -155,6 +218,16 @@ namespace DiscordBot
              */
             virtual void OnMessageDeleted(Message msg) {}
 
+            /**
+             * @brief Called once if multiple messages are deleted at once. OnMessageDeleted isn't called for these messages.
+             * 
+             * @param c: Channel of the deleted messages.
+             * @param IDs: Ids of all deleted messages.
+             * 
+             * @note The GUILD_MESSAGES intent needs to be set to receive this event. This intent is set by default. @see Intent
+             */
+            virtual void OnMessagesDeleted(Channel c, const std::vector<std::string> &IDs) {}
+
             /**
              * @brief Called if a guild becomes available, either after OnReady or if a guild becomes available again.
              * 
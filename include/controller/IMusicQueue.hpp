@@ -82,6 +82,11 @@ namespace DiscordBot
              */
             bool HasNext();
 
+            /**
+             * @return Returns the current song and all songs after it.
+             */
+            std::vector<SongInfo> GetPendingSongs();
+
             /**
              * @brief Returns true if a song is not ready.
              */
@@ -43,6 +43,7 @@ namespace DiscordBot
         MESSAGE_CREATED = 64,
         MESSAGE_EDITED = 128,
         MESSAGE_DELETED = 256,
+        MESSAGES_DELETED = 512,     //!< Action must be from the type std::vector<std::string>, fired once per bulk delete with the message ids
 
         TOTAL_ACTIONS
     };
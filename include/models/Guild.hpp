@@ -45,7 +45,8 @@ namespace DiscordBot
             atomic<std::string> Name;
             atomic<std::string> Icon;
 
-            GuildMember Owner;
+            atomic<std::string> OwnerID;
+            GuildMember Owner;      //!< Null until the member is loaded, if the owner isn't part of the member list. @see IController::OnMemberResolved
 
             atomic<std::map<std::string, GuildMember>> Members;
             atomic<std::map<std::string, Channel>> Channels; 
@@ -58,7 +58,7 @@ namespace DiscordBot
             Channel ChannelRef;     //!< Could contain a dummy channel if this is a dm. Only the id field is filled.
             Guild GuildRef;
             User Author;
-            GuildMember Member;
+            GuildMember Member;     //!< Null if the member isn't cached. It's loaded in the background. @see IController::OnMemberResolved
             std::string Content;
             std::string Timestamp;
             std::string EditedTimestamp;
@@ -0,0 +1,126 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "BotHost.hpp"
+#include <Log.hpp>
+#include <sodium.h>
+#include <thread>
+
+namespace DiscordBot
+{
+    BotHost IBotHost::Create(uint32_t WorkerCount)
+    {
+        if(WorkerCount == 0)
+            WorkerCount = std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+
+        //Needed for windows.
+        ix::initNetSystem();
+
+        //Initialize libsodium.
+        if (sodium_init() < 0) 
+            llog << lerror << "Error to init libsodium" << lendl;
+
+        return BotHost(new CBotHost(WorkerCount));
+    }
+
+    CBotHost::CBotHost(uint32_t WorkerCount) : m_Runtime(new SBotRuntime(WorkerCount))
+    {
+        //Disable client side checking.
+        ix::SocketTLSOptions DisabledTrust;
+        DisabledTrust.caFile = "NONE";
+
+        m_Runtime->HTTPClient->setTLSOptions(DisabledTrust);
+    }
+
+    DiscordClient CBotHost::AddClient(const std::string &Token, Intent Intents)
+    {
+        auto Client = std::make_shared<CDiscordClient>(Token, Intents, m_Runtime);
+
+        std::lock_guard<std::mutex> lock(m_ClientsLock);
+        m_Clients.push_back(Client);
+
+        return Client;
+    }
+
+    void CBotHost::Run()
+    {
+        std::vector<std::shared_ptr<CDiscordClient>> Clients;
+        {
+            std::lock_guard<std::mutex> lock(m_ClientsLock);
+            Clients = m_Clients;
+        }
+
+        for (auto &&e : Clients)
+        {
+            if(!e->Connect(false))
+            {
+                llog << lerror << "Failed to start a client of the host" << lendl;
+                e->Quit();
+            }
+        }
+
+        //Runs until all clients quit.
+        while (!HasQuit())
+        {
+            m_Runtime->Wakeup.Wait(-1);
+            m_Runtime->Wakeup.Clear();
+        }
+    }
+
+    void CBotHost::Quit()
+    {
+        std::vector<std::shared_ptr<CDiscordClient>> Clients;
+        {
+            std::lock_guard<std::mutex> lock(m_ClientsLock);
+            Clients = m_Clients;
+        }
+
+        for (auto &&e : Clients)
+        {
+            if(!e->m_Quit)
+                e->Quit();
+        }
+    }
+
+    bool CBotHost::HasQuit()
+    {
+        std::lock_guard<std::mutex> lock(m_ClientsLock);
+        for (auto &&e : m_Clients)
+        {
+            if(!e->m_Quit)
+                return false;
+        }
+
+        return true;
+    }
+
+    CBotHost::~CBotHost()
+    {
+        Quit();
+
+        //Running lookups post their results to the workers.
+        m_Runtime->Lookups->Stop();
+        m_Runtime->Workers->Stop();
+    }
+} // namespace DiscordBot
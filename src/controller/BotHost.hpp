@@ -0,0 +1,66 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BOTHOST_HPP
+#define BOTHOST_HPP
+
+#include <IBotHost.hpp>
+#include <vector>
+#include <mutex>
+#include "BotRuntime.hpp"
+#include "DiscordClient.hpp"
+
+namespace DiscordBot
+{
+    class CBotHost : public IBotHost
+    {
+        public:
+            CBotHost(uint32_t WorkerCount);
+
+            DiscordClient AddClient(const std::string &Token, Intent Intents = Intent::DEFAULTS) override;
+            void Run() override;
+            void Quit() override;
+
+            Users GetUsers() override
+            {
+                return m_Runtime->Users->load();
+            }
+
+            ~CBotHost();
+
+        private:
+            BotRuntime m_Runtime;
+
+            std::mutex m_ClientsLock;
+            std::vector<std::shared_ptr<CDiscordClient>> m_Clients;
+
+            /**
+             * @return Returns true if all clients have quit.
+             */
+            bool HasQuit();
+    };
+} // namespace DiscordBot
+
+
+#endif //BOTHOST_HPP
@@ -0,0 +1,63 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BOTRUNTIME_HPP
+#define BOTRUNTIME_HPP
+
+#include <IDiscordClient.hpp>
+#include <ixwebsocket/IXHttpClient.h>
+#include <models/atomic.hpp>
+#include <memory>
+#include <algorithm>
+#include "TimerService.hpp"
+#include "WorkerPool.hpp"
+#include "WakeupEvent.hpp"
+
+namespace DiscordBot
+{
+    /**
+     * @brief Resources which are shared by all clients of a bot host. @see IBotHost
+     */
+    struct SBotRuntime
+    {
+        static const uint32_t LOOKUP_WORKERS = 2;   //!< Threads which load uncached members.
+
+        /**
+         * @param WorkerCount: Count of threads which process the events and messages of all clients.
+         */
+        SBotRuntime(uint32_t WorkerCount) : Timer(new CTimerService()), Workers(new CWorkerPool(std::max<uint32_t>(WorkerCount, 1))), Lookups(new CWorkerPool(LOOKUP_WORKERS)), HTTPClient(new ix::HttpClient()), Users(new atomic<DiscordBot::Users>()) {}
+
+        TimerService Timer;
+        WorkerPool Workers;
+        WorkerPool Lookups;                                 //!< Loads uncached members over http for all clients.
+        std::shared_ptr<ix::HttpClient> HTTPClient;
+        std::shared_ptr<atomic<DiscordBot::Users>> Users;  //!< Users which are seen by several bots are stored once.
+        CWakeupEvent Wakeup;                                //!< Signaled if a client quits.
+    };
+
+    using BotRuntime = std::shared_ptr<SBotRuntime>;
+} // namespace DiscordBot
+
+
+#endif //BOTRUNTIME_HPP
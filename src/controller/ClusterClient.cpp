@@ -0,0 +1,198 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ClusterClient.hpp"
+#include <Log.hpp>
+#include "../models/Payload.hpp"
+#include "../helpers/Helper.hpp"
+
+namespace DiscordBot
+{
+    const int CClusterClient::ASSIGN_TIMEOUT;
+
+    CClusterClient::CClusterClient() : m_Assigned(false), m_TotalShards(0), m_NextNonce(0)
+    {
+        m_Socket.setOnMessageCallback(std::bind(&CClusterClient::OnWebsocketEvent, this, std::placeholders::_1));
+    }
+
+    bool CClusterClient::Connect(const std::string &URL)
+    {
+        m_Socket.setUrl(URL);
+        m_Socket.start();
+
+        std::unique_lock<std::mutex> lock(m_Lock);
+        if(!m_Signal.wait_for(lock, std::chrono::milliseconds(ASSIGN_TIMEOUT), [this]{ return m_Assigned; }))
+        {
+            llog << lerror << "Shard coordinator " << URL << " doesn't answer" << lendl;
+            return false;
+        }
+
+        return true;
+    }
+
+    void CClusterClient::RequestIdentify(uint32_t ShardID, IdentifyCallback Callback)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            m_IdentifyCallbacks[ShardID] = Callback;
+        }
+
+        CJSON json;
+        json.AddPair("op", std::string("identify"));
+        json.AddPair("shard", ShardID);
+        m_Socket.send(json.Serialize());
+    }
+
+    std::vector<std::string> CClusterClient::Query(const std::string &Type, int Timeout)
+    {
+        std::string Nonce;
+
+        {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            Nonce = std::to_string(m_NextNonce++);
+            m_Queries[Nonce] = {false, {}};
+        }
+
+        CJSON json;
+        json.AddPair("op", std::string("query"));
+        json.AddPair("nonce", Nonce);
+        json.AddPair("type", Type);
+        m_Socket.send(json.Serialize());
+
+        std::unique_lock<std::mutex> lock(m_Lock);
+        m_Signal.wait_for(lock, std::chrono::milliseconds(Timeout), [this, &Nonce]{ return m_Queries[Nonce].Finished; });
+
+        std::vector<std::string> ret = std::move(m_Queries[Nonce].Data);
+        m_Queries.erase(Nonce);
+
+        return ret;
+    }
+
+    void CClusterClient::Disconnect()
+    {
+        m_Socket.stop();
+    }
+
+    void CClusterClient::OnWebsocketEvent(const ix::WebSocketMessagePtr &msg)
+    {
+        switch (msg->type)
+        {
+            case ix::WebSocketMessageType::Open:
+            {
+                //Requests the shards, also after a reconnect.
+                CJSON json;
+                json.AddPair("op", std::string("hello"));
+                m_Socket.send(json.Serialize());
+            }break;
+
+            case ix::WebSocketMessageType::Close:
+            {
+                llog << linfo << "Lost connection to the shard coordinator code " << msg->closeInfo.code << " Reason " << msg->closeInfo.reason << lendl;
+            }break;
+
+            case ix::WebSocketMessageType::Error:
+            {
+                llog << lerror << "Shard coordinator error: " << msg->errorInfo.reason << lendl;
+            }break;
+
+            case ix::WebSocketMessageType::Message:
+            {
+                try
+                {
+                    CJSON json;
+                    json.ParseObject(msg->str);
+
+                    switch (Adler32(json.GetValue<std::string>("op").c_str()))
+                    {
+                        case Adler32("assign"):
+                        {
+                            std::lock_guard<std::mutex> lock(m_Lock);
+                            m_Shards = json.GetValue<std::vector<uint32_t>>("shards");
+                            m_TotalShards = json.GetValue<uint32_t>("total");
+                            m_Assigned = true;
+                            m_Signal.notify_all();
+                        }break;
+
+                        case Adler32("identify_granted"):
+                        {
+                            IdentifyCallback Callback;
+
+                            {
+                                std::lock_guard<std::mutex> lock(m_Lock);
+                                auto IT = m_IdentifyCallbacks.find(json.GetValue<uint32_t>("shard"));
+                                if(IT != m_IdentifyCallbacks.end())
+                                {
+                                    Callback = IT->second;
+                                    m_IdentifyCallbacks.erase(IT);
+                                }
+                            }
+
+                            if(Callback)
+                                Callback();
+                        }break;
+
+                        case Adler32("query"):
+                        {
+                            QueryHandler Handler;
+                            {
+                                std::lock_guard<std::mutex> lock(m_Lock);
+                                Handler = m_QueryHandler;
+                            }
+
+                            CJSON Result;
+                            Result.AddPair("op", std::string("query_result"));
+                            Result.AddPair("nonce", json.GetValue<std::string>("nonce"));
+                            Result.AddPair("data", Handler ? Handler(json.GetValue<std::string>("type")) : std::vector<std::string>());
+                            m_Socket.send(Result.Serialize());
+                        }break;
+
+                        case Adler32("query_result"):
+                        {
+                            std::lock_guard<std::mutex> lock(m_Lock);
+                            auto IT = m_Queries.find(json.GetValue<std::string>("nonce"));
+                            if(IT != m_Queries.end())
+                            {
+                                IT->second.Data = json.GetValue<std::vector<std::string>>("data");
+                                IT->second.Finished = true;
+                                m_Signal.notify_all();
+                            }
+                        }break;
+                    }
+                }
+                catch (const CJSONException &e)
+                {
+                    llog << lerror << "Failed to parse coordinator message JSON Enumtype: " << GetEnumName(e.GetErrType()) << " what(): " << e.what() << lendl;
+                }
+            }break;
+
+            default:
+                break;
+        }
+    }
+
+    CClusterClient::~CClusterClient()
+    {
+        m_Socket.stop();
+    }
+} // namespace DiscordBot
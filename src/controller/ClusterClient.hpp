@@ -0,0 +1,132 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CLUSTERCLIENT_HPP
+#define CLUSTERCLIENT_HPP
+
+#include <ixwebsocket/IXWebSocket.h>
+#include <JSON.hpp>
+#include <functional>
+#include <map>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+
+namespace DiscordBot
+{
+    /**
+     * @brief Connection of a bot process to the shard coordinator. @see CShardCoordinator
+     */
+    class CClusterClient
+    {
+        public:
+            using IdentifyCallback = std::function<void()>;
+            using QueryHandler = std::function<std::vector<std::string>(const std::string &Type)>;
+
+            CClusterClient();
+
+            /**
+             * @brief Connects to the coordinator and waits for the shard assignment.
+             * 
+             * @return Returns false if the coordinator doesn't answer.
+             */
+            bool Connect(const std::string &URL);
+
+            /**
+             * @return Returns the shards which are assigned to this process.
+             */
+            std::vector<uint32_t> GetShards()
+            {
+                std::lock_guard<std::mutex> lock(m_Lock);
+                return m_Shards;
+            }
+
+            /**
+             * @return Returns the total count of shards of the cluster.
+             */
+            uint32_t GetTotalShards()
+            {
+                std::lock_guard<std::mutex> lock(m_Lock);
+                return m_TotalShards;
+            }
+
+            /**
+             * @brief Requests the permission to identify a shard. The callback is called if the coordinator grants the identify.
+             */
+            void RequestIdentify(uint32_t ShardID, IdentifyCallback Callback);
+
+            /**
+             * @brief Sends a query to all other processes of the cluster and waits for the results.
+             * 
+             * @param Type: Type of the query.
+             * @param Timeout: Maximum time to wait in milliseconds.
+             * 
+             * @return Returns the combined results of all processes.
+             */
+            std::vector<std::string> Query(const std::string &Type, int Timeout = 6000);
+
+            /**
+             * @brief Sets the handler which answers queries of other processes.
+             */
+            void SetQueryHandler(QueryHandler Handler)
+            {
+                std::lock_guard<std::mutex> lock(m_Lock);
+                m_QueryHandler = Handler;
+            }
+
+            void Disconnect();
+
+            ~CClusterClient();
+
+        private:
+            static const int ASSIGN_TIMEOUT = 10000;
+
+            struct SQueryResult
+            {
+                bool Finished;
+                std::vector<std::string> Data;
+            };
+
+            ix::WebSocket m_Socket;
+
+            std::mutex m_Lock;
+            std::condition_variable m_Signal;
+
+            bool m_Assigned;
+            std::vector<uint32_t> m_Shards;
+            uint32_t m_TotalShards;
+
+            std::map<uint32_t, IdentifyCallback> m_IdentifyCallbacks;
+            std::map<std::string, SQueryResult> m_Queries;
+            uint64_t m_NextNonce;
+            QueryHandler m_QueryHandler;
+
+            void OnWebsocketEvent(const ix::WebSocketMessagePtr &msg);
+    };
+} // namespace DiscordBot
+
+
+#endif //CLUSTERCLIENT_HPP
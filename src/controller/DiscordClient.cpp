@@ -37,6 +37,8 @@
 
 namespace DiscordBot
 {
+    const uint32_t CDiscordClient::GATEWAY_VERSION;
+
     DiscordClient IDiscordClient::Create(const std::string &Token, Intent Intents)
     {
         //Needed for windows.
@@ -49,7 +51,7 @@ namespace DiscordBot
         return DiscordClient(new CDiscordClient(Token, Intents));
     }
 
-    CDiscordClient::CDiscordClient(const std::string &Token, Intent Intents) : m_Intents(Intents), m_Token(Token), m_Terminate(false), m_HeartACKReceived(false), m_Quit(false), m_LastSeqNum(-1), m_IsAFK(false), m_State(OnlineState::ONLINE)
+    CDiscordClient::CDiscordClient(const std::string &Token, Intent Intents, BotRuntime Runtime) : m_Runtime(Runtime), m_Timer(Runtime ? Runtime->Timer : TimerService(new CTimerService())), m_EVManger(m_Timer, Runtime ? Runtime->Workers : nullptr), m_Intents(Intents), m_Token(Token), m_BaseURL("https://discord.com/api"), m_HTTPClient(Runtime ? Runtime->HTTPClient : std::make_shared<ix::HttpClient>()), m_Compress(false), m_Encoding(GatewayEncoding::JSON), m_ShardCount(0), m_ShardGeneration(0), m_Resharding(false), m_CheckpointInterval(5000), m_WorkerCount(1), m_QueuedEvents(0), m_External(false), m_DispatchTimeout(0), m_LargeThreshold(50), m_LazyMembers(false), m_Recording(false), m_Replay(false), m_Quit(false), m_Draining(false), m_SharedUsers(Runtime ? Runtime->Users : std::make_shared<atomic<Users>>()), m_Users(*m_SharedUsers), m_IsAFK(false), m_State(OnlineState::ONLINE), m_PresenceTransactions(0), m_PresenceChanged(false), m_PresenceTimer(CTimerService::INVALID_TIMER)
     {
 #ifdef DISCORDBOT_UNIX
         //Ignores the SIGPIPE signal.
@@ -58,39 +60,94 @@ namespace DiscordBot
         USER_AGENT = std::string("libDiscordBot (https://github.com/tostc/libDiscordBot, ") + VERSION + ")";
 
         m_EVManger.SubscribeMessage(QUEUE_NEXT_SONG, std::bind(&CDiscordClient::OnMessageReceive, this, std::placeholders::_1));  
+        m_EVManger.SubscribeMessage(CONNECT, std::bind(&CDiscordClient::OnMessageReceive, this, std::placeholders::_1));  
         m_EVManger.SubscribeMessage(RESUME, std::bind(&CDiscordClient::OnMessageReceive, this, std::placeholders::_1));  
-        m_EVManger.SubscribeMessage(RECONNECT, std::bind(&CDiscordClient::OnMessageReceive, this, std::placeholders::_1));   
-        m_EVManger.SubscribeMessage(QUIT, std::bind(&CDiscordClient::OnMessageReceive, this, std::placeholders::_1));   
+        m_EVManger.SubscribeMessage(HEARTBEAT_TIMEOUT, std::bind(&CDiscordClient::OnMessageReceive, this, std::placeholders::_1));
+        m_EVManger.SubscribeMessage(SAVE_CHECKPOINT, std::bind(&CDiscordClient::OnMessageReceive, this, std::placeholders::_1));   
+        m_EVManger.SubscribeMessage(QUIT, std::bind(&CDiscordClient::OnMessageReceive, this, std::placeholders::_1));
+        m_EVManger.SubscribeMessage(HANDOFF, std::bind(&CDiscordClient::OnMessageReceive, this, std::placeholders::_1));   
+        m_EVManger.SubscribeMessage(RESHARD, std::bind(&CDiscordClient::OnMessageReceive, this, std::placeholders::_1));
+        m_EVManger.SubscribeMessage(RESHARD_TIMEOUT, std::bind(&CDiscordClient::OnMessageReceive, this, std::placeholders::_1));
+        m_EVManger.SubscribeMessage(RELEASE_SHARDS, std::bind(&CDiscordClient::OnMessageReceive, this, std::placeholders::_1));
 
         //Disable client side checking.
         ix::SocketTLSOptions DisabledTrust;
         DisabledTrust.caFile = "NONE";
 
-        m_HTTPClient.setTLSOptions(DisabledTrust);
-        m_Socket.setTLSOptions(DisabledTrust);
+        m_HTTPClient->setTLSOptions(DisabledTrust);
     }
 
     void CDiscordClient::SetState(OnlineState state)
     {
+        std::lock_guard<std::mutex> lock(m_PresenceLock);
         m_State = state;
-        UpdateUserInfo();
+        RequestPresenceUpdate();
     }
 
     void CDiscordClient::SetAFK(bool AFK)
     {
+        std::lock_guard<std::mutex> lock(m_PresenceLock);
         m_IsAFK = AFK;
-        UpdateUserInfo();
+        RequestPresenceUpdate();
     }
 
     void CDiscordClient::SetActivity(const std::string &Text, const std::string &URL)
     {
+        std::lock_guard<std::mutex> lock(m_PresenceLock);
         m_Text = Text;
         m_URL = URL;
-        UpdateUserInfo();
+        RequestPresenceUpdate();
+    }
+
+    void CDiscordClient::BeginPresenceUpdate()
+    {
+        std::lock_guard<std::mutex> lock(m_PresenceLock);
+        m_PresenceTransactions++;
+    }
+
+    void CDiscordClient::CommitPresenceUpdate()
+    {
+        std::lock_guard<std::mutex> lock(m_PresenceLock);
+        if(m_PresenceTransactions == 0)
+            return;
+
+        m_PresenceTransactions--;
+        if(m_PresenceTransactions == 0 && m_PresenceChanged)
+            RequestPresenceUpdate();
+    }
+
+    void CDiscordClient::RequestPresenceUpdate()
+    {
+        m_PresenceChanged = true;
+
+        //Sent on commit.
+        if(m_PresenceTransactions != 0)
+            return;
+
+        //An update is already scheduled and sends the latest state.
+        if(m_PresenceTimer != CTimerService::INVALID_TIMER)
+            return;
+
+        m_PresenceTimer = m_Timer->Schedule(PRESENCE_WINDOW, [this]()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_PresenceLock);
+                m_PresenceTimer = CTimerService::INVALID_TIMER;
+
+                //A transaction began after the update was scheduled. The commit sends the changes.
+                if(m_PresenceTransactions != 0)
+                    return;
+
+                m_PresenceChanged = false;
+            }
+
+            UpdateUserInfo();
+        });
     }
 
     std::string CDiscordClient::CreateUserInfoJSON()
     {
+        std::lock_guard<std::mutex> lock(m_PresenceLock);
         CJSON json;
 
         std::string State = OnlineStateToStr(m_State);
@@ -117,7 +174,13 @@ namespace DiscordBot
 
     void CDiscordClient::UpdateUserInfo()
     {        
-        SendOP(OPCodes::PRESENCE_UPDATE, CreateUserInfoJSON());
+        //The presence is part of each session.
+        std::string Info = CreateUserInfoJSON();
+        for (auto &&e : m_Shards.load())
+            SendOP(e.get(), OPCodes::PRESENCE_UPDATE, Info);
+
+        for (auto &&e : m_StandbyShards.load())
+            SendOP(e.get(), OPCodes::PRESENCE_UPDATE, Info);
     }
 
     void CDiscordClient::ChangeVoiceState(const std::string &Guild, const std::string &Channel)
@@ -133,7 +196,112 @@ namespace DiscordBot
         json.AddPair("self_mute", false);
         json.AddPair("self_deaf", false);
 
-        SendOP(OPCodes::VOICE_STATE_UPDATE, json.Serialize());
+        GatewayShard Shard = GetShard(Guild);
+        if(Shard)
+            SendOP(Shard.get(), OPCodes::VOICE_STATE_UPDATE, json.Serialize());
+    }
+
+    GatewayShard CDiscordClient::GetShard(const std::string &GuildID)
+    {
+        //The id and the count must come from the same shard set.
+        std::vector<GatewayShard> Shards = m_Shards.load();
+        if(Shards.empty())
+            return nullptr;
+
+        uint32_t ID = CGatewayShard::GetShardID(GuildID, Shards.front()->Count);
+        for (auto &&e : Shards)
+        {
+            if(e->ID == ID)
+                return e;
+        }
+
+        return nullptr;
+    }
+
+    GatewayShard CDiscordClient::CreateShard(uint32_t ID, uint32_t Count, uint32_t Generation)
+    {
+        GatewayShard Ret = GatewayShard(new CGatewayShard(ID, Count, m_Timer, Generation));
+        CGatewayShard *Shard = Ret.get();
+
+        Ret->MemberLoader.SetRequestFunc([this, Shard](const std::string &GuildID)
+        {
+            CJSON json;
+            json.AddPair("guild_id", GuildID);
+            json.AddPair("query", std::string());
+            json.AddPair("limit", 0);
+            json.AddPair("nonce", GuildID);
+
+            SendOP(Shard, OPCodes::REQUEST_GUILD_MEMBERS, json.Serialize());
+        });
+
+        return Ret;
+    }
+
+    void CDiscordClient::RequestGuildMembers(Guild guild)
+    {
+        if(!guild)
+            return;
+
+        GatewayShard Shard = GetShard(guild->ID);
+        if(Shard)
+            Shard->MemberLoader.Request(guild->ID);
+    }
+
+    GatewayShard CDiscordClient::FindShard(uint32_t ID)
+    {
+        for (auto &&e : m_Shards.load())
+        {
+            if(e->ID == ID)
+                return e;
+        }
+
+        return nullptr;
+    }
+
+    std::vector<SShardStatus> CDiscordClient::GetShardStatus()
+    {
+        std::vector<SShardStatus> ret;
+        std::vector<GatewayShard> Shards = m_Shards.load();
+        for (auto &&e : m_StandbyShards.load())
+            Shards.push_back(e);
+
+        for (auto &&e : Shards)
+        {
+            SShardStatus Status;
+            Status.ID = e->ID;
+            Status.Ready = e->Ready;
+            Status.QueueDepth = e->Outbound.GetDepth();
+            Status.QueueWait = e->Outbound.GetWaitTime();
+            Status.Tokens = e->Outbound.GetTokens();
+            Status.Latency = e->Latency.GetLast();
+            Status.AvgLatency = e->Latency.GetAverage();
+            Status.P99Latency = e->Latency.GetP99();
+            Status.Standby = e->Standby;
+            ret.push_back(Status);
+        }
+
+        return ret;
+    }
+
+    std::vector<std::string> CDiscordClient::GetLocalGuildIDs()
+    {
+        std::vector<std::string> ret;
+        for (auto &&e : m_Guilds.load())
+            ret.push_back(e.first);
+
+        return ret;
+    }
+
+    std::vector<std::string> CDiscordClient::GetClusterGuilds()
+    {
+        std::vector<std::string> ret = GetLocalGuildIDs();
+        if(m_Cluster)
+        {
+            auto Remote = m_Cluster->Query("guilds");
+            ret.insert(ret.end(), Remote.begin(), Remote.end());
+        }
+
+        return ret;
     }
 
     void CDiscordClient::Join(Channel channel)
@@ -217,6 +385,47 @@ namespace DiscordBot
     }
 
     void CDiscordClient::Run()
+    {
+        if(!Connect(false))
+            return;
+
+        //Runs until the bot quits.
+        while (Poll(-1));
+    }
+
+    bool CDiscordClient::Start()
+    {
+        return Connect(true);
+    }
+
+    bool CDiscordClient::Poll(int32_t Timeout)
+    {
+        m_Wakeup.Wait(Timeout);
+        return RunOnce();
+    }
+
+    bool CDiscordClient::RunOnce()
+    {
+        //Events which are queued after clearing signal the event again.
+        m_Wakeup.Clear();
+
+        WorkerPool Workers = m_Workers;
+        if(Workers && !m_Quit)
+            Workers->RunPending();
+
+        return !m_Quit;
+    }
+
+    void CDiscordClient::NotifyController(std::function<void()> Callback, const std::string &Key)
+    {
+        //Runs on the workers like the events, so a single worker never calls the controller twice at the same time.
+        if(m_Workers)
+            PostEvent(Key, Callback);
+        else
+            Callback();
+    }
+
+    bool CDiscordClient::Connect(bool External)
     {
         //Requests the gateway endpoint for bots.
         auto res = Get("/gateway/bot");
@@ -226,173 +435,874 @@ namespace DiscordBot
             {
                 CJSON json;
                 m_Gateway = json.Deserialize<std::shared_ptr<SGateway>>(res->body);
+                if(!m_GatewayURL.empty())
+                    m_Gateway->URL = m_GatewayURL;
             }
             catch (const CJSONException &e)
             {
                 llog << lerror << "Failed to parse JSON Enumtype: " << GetEnumName(e.GetErrType()) << " what(): " << e.what() << lendl;
-                return;
+                return false;
+            }
+
+            m_Shards->clear();
+            m_External = External;
+
+            //Without own workers the events are queued for the host.
+            if(m_Runtime)
+            {
+                m_External = false;
+                m_Workers = m_Runtime->Workers;
+            }
+            else if(External)
+                m_Workers = std::make_shared<CWorkerPool>(0, std::bind(&CWakeupEvent::Signal, &m_Wakeup));
+            else
+                m_Workers = std::make_shared<CWorkerPool>(m_WorkerCount);
+
+            m_Lookups = m_Runtime ? m_Runtime->Lookups : WorkerPool(new CWorkerPool(SBotRuntime::LOOKUP_WORKERS));
+            m_Identifier.SetLimit(m_Gateway->Limit.Total, m_Gateway->Limit.Remaining, m_Gateway->Limit.ResetAfter, m_Gateway->Limit.MaxConcurrency);
+
+            if(!m_ClusterURL.empty())
+            {
+                m_Cluster = std::make_shared<CClusterClient>();
+                m_Cluster->SetQueryHandler([this](const std::string &Type)
+                {
+                    if(Type == "guilds")
+                        return GetLocalGuildIDs();
+
+                    return std::vector<std::string>();
+                });
+
+                if(!m_Cluster->Connect(m_ClusterURL))
+                    return false;
+
+                //The coordinator controls the identify timing.
+                uint32_t Count = m_Cluster->GetTotalShards();
+                for (auto &&e : m_Cluster->GetShards())
+                    m_Shards->push_back(CreateShard(e, Count));
+            }
+            else
+            {
+                //The identify scheduler controls the identify timing.
+                uint32_t Count = m_ShardCount != 0 ? m_ShardCount : std::max<uint32_t>(m_Gateway->Shards, 1);
+                for (uint32_t i = 0; i < Count; i++)
+                    m_Shards->push_back(CreateShard(i, Count));
+            }
+
+            if(!m_CheckpointFile.empty())
+            {
+                //A resumed session doesn't receive the READY event, so the bot user is requested.
+                if(RestoreCheckpoint())
+                {
+                    auto UserRes = Get("/users/@me");
+                    if(UserRes->statusCode == 200)
+                        UserRes->body >> m_BotUser >> m_Users;
+                }
+
+                m_EVManger.PostMessage(SAVE_CHECKPOINT, 0, m_CheckpointInterval);
+            }
+
+            if(!m_RecordFile.empty())
+            {
+                STrafficInfo Info;
+                Info.ShardCount = m_Shards->front()->Count;
+                Info.GatewayVersion = GATEWAY_VERSION;
+                Info.Compressed = m_Compress;
+                Info.Encoding = m_Encoding;
+
+                m_Recording = m_Recorder.Open(m_RecordFile, Info);
             }
 
-            //Connects to discords websocket.
-            m_Socket.setUrl(m_Gateway->URL + "/?v=8&encoding=json");
-            m_Socket.setOnMessageCallback(std::bind(&CDiscordClient::OnWebsocketEvent, this, std::placeholders::_1));
-            m_Socket.start();
+            for (auto &&e : m_Shards.load())
+                m_EVManger.PostMessage(CONNECT, std::weak_ptr<CGatewayShard>(e));
 
-            //Runs until the bot quits.
-            while (!m_Quit)
-                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            return true;
         }
         else
             llog << lerror << "HTTP " << res->statusCode << " Error " << res->errorMsg << lendl;
+
+        return false;
     }
 
-    void CDiscordClient::Quit()
+    void CDiscordClient::Replay(const std::string &File, bool RealTime)
     {
-        auto IT = m_Guilds->begin();
-        while (IT != m_Guilds->end())
+        CTrafficReader Reader;
+        if(!Reader.Open(File))
         {
-            Leave(IT->second);
-            IT++;
+            llog << lerror << "Failed to open the traffic record " << File << lendl;
+            return;
         }
 
-        m_Terminate = true;
-        if (m_Heartbeat.joinable())
-            m_Heartbeat.join();
+        //The frames are decoded like they were received.
+        const STrafficInfo &Info = Reader.GetInfo();
+        m_Compress = Info.Compressed;
+        m_Encoding = Info.Encoding;
 
-        m_Socket.stop();
-        
-        if (m_Controller)
+        if(Info.GatewayVersion != GATEWAY_VERSION)
+            llog << lerror << "The traffic record uses gateway version " << Info.GatewayVersion << ", this client uses version " << GATEWAY_VERSION << lendl;
+
+        //Nothing is sent or connected during a replay.
+        m_Replay = true;
+        m_Shards->clear();
+        m_Workers = std::make_shared<CWorkerPool>(m_WorkerCount);
+
+        uint32_t Count = std::max<uint32_t>(Info.ShardCount, 1);
+        for (uint32_t i = 0; i < Count; i++)
+            m_Shards->push_back(CreateShard(i, Count));
+
+        STrafficRecord Record;
+        int64_t First = -1;
+        auto Start = std::chrono::steady_clock::now();
+
+        while (!m_Quit && Reader.Read(Record))
         {
-            m_Controller->OnDisconnect();
-            m_Controller->OnQuit();
-            m_Controller = nullptr;
+            GatewayShard Shard = FindShard(Record.ShardID);
+            if(!Shard)
+                continue;
+
+            if(RealTime)
+            {
+                if(First == -1)
+                    First = Record.Timestamp;
+
+                std::this_thread::sleep_until(Start + std::chrono::milliseconds(Record.Timestamp - First));
+            }
+
+            ix::WebSocketMessageType Type = ix::WebSocketMessageType::Message;
+            if(Record.Type == FrameType::OPEN)
+                Type = ix::WebSocketMessageType::Open;
+            else if(Record.Type == FrameType::CLOSE)
+                Type = ix::WebSocketMessageType::Close;
+
+            ix::WebSocketMessagePtr Msg = ix::WebSocketMessagePtr(new ix::WebSocketMessage(Type, Record.Data, Record.Data.size(), ix::WebSocketErrorInfo(), ix::WebSocketOpenInfo(), ix::WebSocketCloseInfo(), Record.Type == FrameType::BINARY));
+            OnWebsocketEvent(Shard.get(), Msg);
         }
 
-        m_Guilds->clear();
-        m_VoiceSockets->clear();
-        m_AudioSources->clear();
-        m_Users->clear();
-        m_MusicQueues->clear();
-        m_Quit = true;
+        m_Workers->Wait();
     }
 
-    void CDiscordClient::QuitAsync()
+    void CDiscordClient::Quit()
     {
-        m_EVManger.PostMessage(QUIT, 0, 200);
+        Shutdown(false);
     }
 
-    void CDiscordClient::AddToQueue(Guild guild, SongInfo Info)
+    void CDiscordClient::Handoff()
     {
-        if(!guild)
+        if(m_CheckpointFile.empty())
+        {
+            llog << lerror << "Handoff needs a session checkpoint file" << lendl;
+            Quit();
             return;
+        }
 
-        auto IT = m_MusicQueues->find(guild->ID);
-        if(IT != m_MusicQueues->end())
-            IT->second->AddSong(Info);
-        else if(m_QueueFactory)
+        //A worker of a bot host can't wait for the events which are queued behind it, so the drain runs on its own thread.
+        if(m_Runtime && m_Runtime->Workers->IsWorkerThread())
         {
-            auto Tmp = m_QueueFactory->Create();
-            Tmp->SetGuildID(guild->ID);
-            Tmp->SetOnWaitFinishCallback(std::bind(&CDiscordClient::OnQueueWaitFinish, this, std::placeholders::_1, std::placeholders::_2));
-            Tmp->AddSong(Info);
-            m_MusicQueues->insert({guild->ID, Tmp});
+            if(!m_HandoffThread.joinable())
+                m_HandoffThread = std::thread(&CDiscordClient::Shutdown, this, true);
+
+            return;
         }
+
+        Shutdown(true);
     }
 
-    bool CDiscordClient::StartSpeaking(Channel channel)
+    void CDiscordClient::HandoffAsync()
     {
-        if (!channel || channel->GuildID->empty())
-            return false;
+        m_EVManger.PostMessage(HANDOFF, 0, 200);
+    }
 
-        AudioSource Source;
+    void CDiscordClient::Shutdown(bool Handoff)
+    {
+        //The next process joins the voice channels again.
+        if(!Handoff)
+        {
+            auto IT = m_Guilds->begin();
+            while (IT != m_Guilds->end())
+            {
+                Leave(IT->second);
+                IT++;
+            }
+        }
 
-        auto IT = m_MusicQueues->find(channel->GuildID);
-        if(IT != m_MusicQueues->end())
+        //Closes the connections with a non-normal code, otherwise Discord invalidates the sessions.
+        bool KeepSessions = !m_CheckpointFile.empty();
+        if (KeepSessions && !Handoff)
+            SaveCheckpoint();
+
+        //A running resharding is dropped, the next start uses the old shard count.
+        m_Resharding = false;
+        RetireShards(m_StandbyShards.load());
+        m_StandbyShards->clear();
+
+        m_Draining = Handoff;
+        for (auto &&e : m_Shards.load())
         {
-            if(IT->second->HasNext())
-                Source = IT->second->Next();
+            e->Terminate = true;
+            e->ReconnectPending = true;
+            StopHeartbeat(e.get());
+
+            if (KeepSessions)
+                e->Socket.stop(4000, "Restart");
             else
-                IT->second->ClearQueue();
+                e->Socket.stop();
         }
 
-        return StartSpeaking(channel, Source);
-    }
+        //No new events are received, so the caches are complete after the queued events.
+        if(Handoff)
+        {
+            //The pool of a bot host also runs the events of the other clients, so only the own events are drained.
+            if(m_Runtime)
+                WaitForEvents();
+            else if(m_Workers)
+                m_Workers->Wait();
+
+            SaveCheckpoint(true);
+            llog << linfo << "Handoff checkpoint written " << m_CheckpointFile << lendl;
+        }
 
-    bool CDiscordClient::StartSpeaking(Channel channel, AudioSource source)
-    {
-        if (!channel || channel->GuildID->empty())
-            return false;
+        m_Identifier.Stop();
 
-        VoiceSockets::iterator IT = m_VoiceSockets->find(channel->GuildID);
-        if (IT != m_VoiceSockets->end() && source)
-            IT->second->StartSpeaking(source);
-        else if(source)
+        TimerID PresenceTimer;
         {
-            Join(channel);
-
-            m_AudioSources->insert({channel->GuildID, source});
+            std::lock_guard<std::mutex> lock(m_PresenceLock);
+            PresenceTimer = m_PresenceTimer;
+            m_PresenceTimer = CTimerService::INVALID_TIMER;
         }
 
-        return true;
-    }
+        m_Timer->Cancel(PresenceTimer);
 
-    void CDiscordClient::PauseSpeaking(Guild guild)
-    {
-        if(!guild)
-            return;
+        //Running lookups finish before the workers stop, because they post their results to them. The bot host stops its pools itself.
+        if (m_Lookups && !m_Runtime)
+            m_Lookups->Stop();
 
-        VoiceSockets::iterator IT = m_VoiceSockets->find(guild->ID);
-        if (IT != m_VoiceSockets->end())
-            IT->second->PauseSpeaking();
-    }
+        //The pool of a bot host is used by the other clients.
+        if (m_Workers && !m_Runtime)
+            m_Workers->Stop();
 
-    void CDiscordClient::ResumeSpeaking(Guild guild) 
-    {
-        if(!guild)
-            return;
+        m_Recorder.Close();
 
-        VoiceSockets::iterator IT = m_VoiceSockets->find(guild->ID);
-        if (IT != m_VoiceSockets->end())
-            IT->second->ResumeSpeaking();
-    }
+        if (m_Cluster)
+            m_Cluster->Disconnect();
+        
+        if (m_Controller)
+        {
+            m_Controller->OnDisconnect();
+            m_Controller->OnQuit();
+            m_Controller = nullptr;
+        }
 
-    void CDiscordClient::StopSpeaking(Guild guild)
-    {
-        if(!guild)
-            return;
+        m_Guilds->clear();
+        m_VoiceSockets->clear();
+        m_AudioSources->clear();
+        if(!m_Runtime)
+            m_Users->clear();
 
-        VoiceSockets::iterator IT = m_VoiceSockets->find(guild->ID);
-        if (IT != m_VoiceSockets->end())
-            IT->second->StopSpeaking();
+        m_MusicQueues->clear();
+        m_Quit = true;
+
+        //Wakes up Run() or the event loop of the host.
+        m_Wakeup.Signal();
+        if(m_Runtime)
+            m_Runtime->Wakeup.Signal();
     }
 
-    void CDiscordClient::RemoveSong(Channel channel, size_t Index)
+    void CDiscordClient::ConnectShard(GatewayShard Shard)
     {
-        if (!channel || channel->GuildID->empty())
+        if(m_Replay)
             return;
 
-        auto IT = m_MusicQueues->find(channel->GuildID);
-        if(IT != m_MusicQueues->end())
-            IT->second->RemoveSong(Index);
+        //Disable client side checking.
+        ix::SocketTLSOptions DisabledTrust;
+        DisabledTrust.caFile = "NONE";
+
+        //Connects to discords websocket.
+        Shard->Socket.setTLSOptions(DisabledTrust);
+        Shard->Socket.disableAutomaticReconnection();
+        Shard->Socket.setUrl(GetShardURL(Shard.get()));
+        Shard->Socket.setOnMessageCallback(std::bind(&CDiscordClient::OnWebsocketEvent, this, Shard.get(), std::placeholders::_1));
+        Shard->Socket.start();
     }
 
-    void CDiscordClient::RemoveSong(Channel channel, const std::string &Name)
+    std::string CDiscordClient::GetShardURL(CGatewayShard *Shard)
     {
-        if (!channel || channel->GuildID->empty())
-            return;
+        //Sessions must be resumed on the url of the READY event.
+        std::string URL = m_Gateway->URL;
+        if(!Shard->SessionID->empty() && !Shard->ResumeURL->empty())
+            URL = Shard->ResumeURL;
 
-        auto IT = m_MusicQueues->find(channel->GuildID);
-        if(IT != m_MusicQueues->end())
-            IT->second->RemoveSong(Name);
+        URL += "/?v=" + std::to_string(GATEWAY_VERSION) + "&encoding=";
+        URL += (m_Encoding == GatewayEncoding::ETF ? "etf" : "json");
+        if(m_Compress)
+            URL += "&compress=zlib-stream";
+
+        return URL;
     }
 
-    void CDiscordClient::OnMessageReceive(MessageBase Msg)
+    void CDiscordClient::SaveCheckpoint(bool Caches)
     {
-        switch (Msg->Event)
+        SSessionCheckpoint Checkpoint;
+        Checkpoint.Timestamp = GetTimeMillis();
+        std::vector<GatewayShard> Shards = m_Shards.load();
+        Checkpoint.ShardCount = Shards.empty() ? 0 : Shards.front()->Count;
+
+        for (auto &&e : Shards)
         {
-            case QUEUE_NEXT_SONG:
-            {
-                auto Data = std::static_pointer_cast<TMessage<std::string>>(Msg);
+            if(e->SessionID->empty())
+                continue;
+
+            SShardSession Session;
+            Session.ID = e->ID;
+            Session.SessionID = e->SessionID;
+            Session.Seq = e->LastSeqNum;
+            Session.ResumeURL = e->ResumeURL;
+            Checkpoint.Shards.push_back(Session);
+        }
+
+        if(Caches)
+        {
+            for (auto &&e : m_Guilds.load())
+            {
+                Checkpoint.Guilds.push_back(SerializeGuild(e.second));
+
+                GuildMember Bot = m_BotUser ? GetBotMember(e.second) : nullptr;
+                if(Bot && Bot->State && Bot->State->ChannelRef)
+                {
+                    SVoiceSession Voice;
+                    Voice.GuildID = e.second->ID;
+                    Voice.ChannelID = Bot->State->ChannelRef->ID;
+                    Checkpoint.VoiceSessions.push_back(Voice);
+                }
+            }
+
+            for (auto &&e : m_MusicQueues.load())
+            {
+                for (auto &&Info : e.second->GetPendingSongs())
+                {
+                    if(!Info)
+                        continue;
+
+                    SQueuedSong Song;
+                    Song.GuildID = e.first;
+                    Song.Name = Info->Name;
+                    Song.Path = Info->Path;
+                    Song.Duration = Info->Duration;
+                    Checkpoint.Songs.push_back(Song);
+                }
+            }
+        }
+
+        Checkpoint.Save(m_CheckpointFile);
+    }
+
+    bool CDiscordClient::RestoreCheckpoint()
+    {
+        SSessionCheckpoint Checkpoint;
+        if(!Checkpoint.Load(m_CheckpointFile))
+            return false;
+
+        if(GetTimeMillis() - Checkpoint.Timestamp > CHECKPOINT_MAX_AGE || m_Shards->empty() || Checkpoint.ShardCount != m_Shards->front()->Count)
+        {
+            llog << linfo << "Session checkpoint is outdated" << lendl;
+            return false;
+        }
+
+        bool Ret = false;
+        for (auto &&e : Checkpoint.Shards)
+        {
+            GatewayShard Shard = FindShard(e.ID);
+            if(Shard)
+            {
+                Shard->SessionID = e.SessionID;
+                Shard->LastSeqNum = e.Seq;
+                Shard->ResumeURL = e.ResumeURL;
+                Ret = true;
+            }
+        }
+
+        //A resumed session doesn't receive the guilds again.
+        if(Ret)
+        {
+            for (auto &&e : Checkpoint.Guilds)
+            {
+                try
+                {
+                    CJSON json;
+                    json.ParseObject(e);
+
+                    Guild guild = CreateGuild(json);
+                    m_Guilds->insert({guild->ID, guild});
+                }
+                catch (const CJSONException &e)
+                {
+                    llog << lerror << "Failed to restore a guild Enumtype: " << GetEnumName(e.GetErrType()) << " what(): " << e.what() << lendl;
+                }
+            }
+
+            //The queues are played again, after the voice channels are joined. @see RejoinVoice
+            for (auto &&e : Checkpoint.Songs)
+            {
+                auto IT = m_Guilds->find(e.GuildID);
+                if(IT == m_Guilds->end())
+                    continue;
+
+                SongInfo Info = SongInfo(new CSongInfo());
+                Info->Name = e.Name;
+                Info->Path = e.Path;
+                Info->Duration = e.Duration;
+                AddToQueue(IT->second, Info);
+            }
+
+            std::lock_guard<std::mutex> lock(m_VoiceSessionsLock);
+            m_VoiceSessions = Checkpoint.VoiceSessions;
+
+            if(!Checkpoint.Guilds.empty())
+                llog << linfo << "Restored " << Checkpoint.Guilds.size() << " guilds from the checkpoint" << lendl;
+        }
+
+        return Ret;
+    }
+
+    void CDiscordClient::RejoinVoice(CGatewayShard *Shard)
+    {
+        std::vector<SVoiceSession> Sessions;
+        {
+            std::lock_guard<std::mutex> lock(m_VoiceSessionsLock);
+            auto IT = m_VoiceSessions.begin();
+            while (IT != m_VoiceSessions.end())
+            {
+                if(CGatewayShard::GetShardID(IT->GuildID, Shard->Count) == Shard->ID)
+                {
+                    Sessions.push_back(*IT);
+                    IT = m_VoiceSessions.erase(IT);
+                }
+                else
+                    IT++;
+            }
+        }
+
+        for (auto &&e : Sessions)
+        {
+            llog << linfo << "Rejoining voice channel " << e.ChannelID << " of guild " << e.GuildID << lendl;
+
+            //Joins with the restored music queue.
+            Channel channel;
+            auto GIT = m_Guilds->find(e.GuildID);
+            if(GIT != m_Guilds->end())
+            {
+                auto CIT = GIT->second->Channels->find(e.ChannelID);
+                if(CIT != GIT->second->Channels->end())
+                    channel = CIT->second;
+            }
+
+            auto MQIT = m_MusicQueues->find(e.GuildID);
+            if(channel && MQIT != m_MusicQueues->end() && MQIT->second->HasNext())
+                StartSpeaking(channel);
+            else
+                ChangeVoiceState(e.GuildID, e.ChannelID);
+        }
+    }
+
+    bool CDiscordClient::Reshard(uint32_t Count)
+    {
+        //The coordinator assigns the shards of a cluster.
+        if(m_Cluster)
+        {
+            llog << lerror << "Resharding isn't supported inside a cluster" << lendl;
+            return false;
+        }
+
+        if(Count == 0 || m_Quit || m_Replay || m_Shards->empty() || m_Resharding.exchange(true))
+            return false;
+
+        uint32_t Generation = ++m_ShardGeneration;
+        std::vector<GatewayShard> Standby;
+        for (uint32_t i = 0; i < Count; i++)
+        {
+            GatewayShard Shard = CreateShard(i, Count, Generation);
+            Shard->Standby = true;
+            Standby.push_back(Shard);
+        }
+
+        m_StandbyShards = Standby;
+        llog << linfo << "Resharding to " << Count << " shards" << lendl;
+
+        for (auto &&e : Standby)
+            m_EVManger.PostMessage(CONNECT, std::weak_ptr<CGatewayShard>(e));
+
+        m_EVManger.PostMessage(RESHARD_TIMEOUT, Generation, RESHARD_MAX_WAIT);
+        return true;
+    }
+
+    void CDiscordClient::OnStandbyDispatch(CGatewayShard *Shard, GatewayEvent Event, const std::string &Data, const SEnvelope &Env)
+    {
+        switch (Event)
+        {
+            case GatewayEvent::READY:
+            {
+                try
+                {
+                    CJSON json;
+                    json.ParseObject(Env.GetD(Data));
+                    Shard->SessionID = json.GetValue<std::string>("session_id");
+
+                    try
+                    {
+                        Shard->ResumeURL = json.GetValue<std::string>("resume_gateway_url");
+                    }
+                    catch (const CJSONException &e)
+                    {
+                        Shard->ResumeURL = "";
+                    }
+
+                    auto Unavailables = json.GetValue<std::vector<std::string>>("guilds");
+                    for (auto &&e : Unavailables)
+                    {
+                        CJSON tmp;
+                        tmp.ParseObject(e);
+
+                        Shard->AddUnavailable(tmp.GetValue<std::string>("id"));
+                    }
+
+                    llog << linfo << "Standby shard " << Shard->ID << " connected, waiting for " << Unavailables.size() << " guilds" << lendl;
+                }
+                catch (const CJSONException &e)
+                {
+                    llog << lerror << "Failed to parse JSON Enumtype: " << GetEnumName(e.GetErrType()) << " what(): " << e.what() << lendl;
+                    return;
+                }
+
+                Shard->Ready = true;
+                Shard->Backoff.Reset();
+                Shard->Outbound.OnReady();
+            }break;
+
+            case GatewayEvent::RESUMED:
+            {
+                Shard->Backoff.Reset();
+                Shard->Outbound.OnReady();
+            }break;
+
+            //Only the id is needed, the guild cache is still owned by the current shards.
+            case GatewayEvent::GUILD_CREATE:
+            {
+                CJSONScanner Scanner(Data, Env.D);
+                SJSONRange Value;
+                if(Scanner.Find("id", Value))
+                    Shard->RemoveUnavailable(Scanner.GetString(Value));
+            }break;
+
+            default:
+                return;
+        }
+
+        CheckReshard();
+    }
+
+    void CDiscordClient::CheckReshard()
+    {
+        for (auto &&e : m_StandbyShards.load())
+        {
+            if(!e->Ready || e->HasUnavailables())
+                return;
+        }
+
+        m_EVManger.PostMessage(RESHARD, (uint32_t)m_ShardGeneration);
+    }
+
+    void CDiscordClient::SwitchShards(uint32_t Generation, bool Timeout)
+    {
+        if(m_Quit || !m_Resharding || Generation != m_ShardGeneration)
+            return;
+
+        std::vector<GatewayShard> Standby = m_StandbyShards.load();
+        bool Connected = !Standby.empty();
+        bool Complete = true;
+
+        for (auto &&e : Standby)
+        {
+            Connected = Connected && e->Ready;
+            Complete = Complete && !e->HasUnavailables();
+        }
+
+        if(!Connected)
+        {
+            //The current shards keep running.
+            if(Timeout)
+            {
+                llog << lerror << "Resharding failed, not all new shards are connected" << lendl;
+                m_Resharding = false;
+                m_StandbyShards->clear();
+                RetireShards(Standby);
+            }
+
+            return;
+        }
+
+        if(!Complete)
+        {
+            if(!Timeout)
+                return;
+
+            //The remaining guilds become available on the new shards.
+            llog << linfo << "Resharding timed out, switching with unavailable guilds" << lendl;
+        }
+
+        if(!m_Resharding.exchange(false))
+            return;
+
+        //The new shards dispatch before the old ones stop, so events around the switch may arrive twice but aren't lost.
+        std::vector<GatewayShard> Old = m_Shards.load();
+        for (auto &&e : Standby)
+        {
+            e->Standby = false;
+            e->MemberLoader.Start();
+        }
+
+        m_Shards = Standby;
+        m_StandbyShards->clear();
+        RetireShards(Old);
+
+        MoveVoice();
+
+        if(!m_CheckpointFile.empty())
+            SaveCheckpoint();
+
+        llog << linfo << "Resharding finished, running " << Standby.size() << " shards" << lendl;
+    }
+
+    void CDiscordClient::RetireShards(const std::vector<GatewayShard> &Shards)
+    {
+        for (auto &&e : Shards)
+        {
+            e->Retired = true;
+            e->Terminate = true;
+            e->ReconnectPending = true;
+            StopHeartbeat(e.get());
+            m_Identifier.Cancel(e->ID, e->Generation);
+
+            //Closes with a non-normal code. A normal close ends the session and its voice states, maybe before the new shards took them over.
+            e->Socket.stop(4000, "Resharding");
+            m_RetiredShards->push_back(e);
+        }
+
+        if(!Shards.empty())
+            m_EVManger.PostMessage(RELEASE_SHARDS, 0, RELEASE_INTERVAL);
+    }
+
+    void CDiscordClient::ReleaseShards()
+    {
+        //The sockets are stopped, so only the queued events still use the shards.
+        bool Pending = false;
+        {
+            auto Retired = m_RetiredShards.operator->();
+            auto IT = Retired->begin();
+            while (IT != Retired->end())
+            {
+                if((*IT)->QueuedEvents == 0)
+                    IT = Retired->erase(IT);
+                else
+                {
+                    Pending = true;
+                    IT++;
+                }
+            }
+        }
+
+        if(Pending && !m_Quit)
+            m_EVManger.PostMessage(RELEASE_SHARDS, 0, RELEASE_INTERVAL);
+    }
+
+    void CDiscordClient::MoveVoice()
+    {
+        std::vector<std::string> GuildIDs;
+        for (auto &&e : m_VoiceSockets.load())
+            GuildIDs.push_back(e.first);
+
+        for (auto &&e : GuildIDs)
+        {
+            auto IT = m_Guilds->find(e);
+            if(IT == m_Guilds->end())
+                continue;
+
+            GuildMember Bot = GetBotMember(IT->second);
+            if(Bot && Bot->State && Bot->State->ChannelRef)
+                ChangeVoiceState(e, Bot->State->ChannelRef->ID);
+        }
+    }
+
+    CDiscordClient::~CDiscordClient()
+    {
+        TimerID PresenceTimer;
+        {
+            std::lock_guard<std::mutex> lock(m_PresenceLock);
+            PresenceTimer = m_PresenceTimer;
+        }
+
+        m_Timer->Cancel(PresenceTimer);
+
+        if(m_HandoffThread.joinable())
+            m_HandoffThread.join();
+    }
+
+    void CDiscordClient::PostEvent(const std::string &Key, CWorkerPool::Task Task)
+    {
+        if(!m_Runtime)
+        {
+            m_Workers->Post(Key, Task);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_EventsLock);
+            m_QueuedEvents++;
+        }
+
+        m_Workers->Post(Key, [this, Task]()
+        {
+            try
+            {
+                Task();
+            }
+            catch (...)
+            {
+                OnEventDone();
+                throw;
+            }
+
+            OnEventDone();
+        });
+    }
+
+    void CDiscordClient::OnEventDone()
+    {
+        std::lock_guard<std::mutex> lock(m_EventsLock);
+        if(--m_QueuedEvents == 0)
+            m_EventsDone.notify_all();
+    }
+
+    void CDiscordClient::WaitForEvents()
+    {
+        std::unique_lock<std::mutex> lock(m_EventsLock);
+        m_EventsDone.wait(lock, [this]() { return m_QueuedEvents == 0; });
+    }
+
+    void CDiscordClient::QuitAsync()
+    {
+        m_EVManger.PostMessage(QUIT, 0, 200);
+    }
+
+    void CDiscordClient::AddToQueue(Guild guild, SongInfo Info)
+    {
+        if(!guild)
+            return;
+
+        auto IT = m_MusicQueues->find(guild->ID);
+        if(IT != m_MusicQueues->end())
+            IT->second->AddSong(Info);
+        else if(m_QueueFactory)
+        {
+            auto Tmp = m_QueueFactory->Create();
+            Tmp->SetGuildID(guild->ID);
+            Tmp->SetOnWaitFinishCallback(std::bind(&CDiscordClient::OnQueueWaitFinish, this, std::placeholders::_1, std::placeholders::_2));
+            Tmp->AddSong(Info);
+            m_MusicQueues->insert({guild->ID, Tmp});
+        }
+    }
+
+    bool CDiscordClient::StartSpeaking(Channel channel)
+    {
+        if (!channel || channel->GuildID->empty())
+            return false;
+
+        AudioSource Source;
+
+        auto IT = m_MusicQueues->find(channel->GuildID);
+        if(IT != m_MusicQueues->end())
+        {
+            if(IT->second->HasNext())
+                Source = IT->second->Next();
+            else
+                IT->second->ClearQueue();
+        }
+
+        return StartSpeaking(channel, Source);
+    }
+
+    bool CDiscordClient::StartSpeaking(Channel channel, AudioSource source)
+    {
+        if (!channel || channel->GuildID->empty())
+            return false;
+
+        VoiceSockets::iterator IT = m_VoiceSockets->find(channel->GuildID);
+        if (IT != m_VoiceSockets->end() && source)
+            IT->second->StartSpeaking(source);
+        else if(source)
+        {
+            Join(channel);
+
+            m_AudioSources->insert({channel->GuildID, source});
+        }
+
+        return true;
+    }
+
+    void CDiscordClient::PauseSpeaking(Guild guild)
+    {
+        if(!guild)
+            return;
+
+        VoiceSockets::iterator IT = m_VoiceSockets->find(guild->ID);
+        if (IT != m_VoiceSockets->end())
+            IT->second->PauseSpeaking();
+    }
+
+    void CDiscordClient::ResumeSpeaking(Guild guild) 
+    {
+        if(!guild)
+            return;
+
+        VoiceSockets::iterator IT = m_VoiceSockets->find(guild->ID);
+        if (IT != m_VoiceSockets->end())
+            IT->second->ResumeSpeaking();
+    }
+
+    void CDiscordClient::StopSpeaking(Guild guild)
+    {
+        if(!guild)
+            return;
+
+        VoiceSockets::iterator IT = m_VoiceSockets->find(guild->ID);
+        if (IT != m_VoiceSockets->end())
+            IT->second->StopSpeaking();
+    }
+
+    void CDiscordClient::RemoveSong(Channel channel, size_t Index)
+    {
+        if (!channel || channel->GuildID->empty())
+            return;
+
+        auto IT = m_MusicQueues->find(channel->GuildID);
+        if(IT != m_MusicQueues->end())
+            IT->second->RemoveSong(Index);
+    }
+
+    void CDiscordClient::RemoveSong(Channel channel, const std::string &Name)
+    {
+        if (!channel || channel->GuildID->empty())
+            return;
+
+        auto IT = m_MusicQueues->find(channel->GuildID);
+        if(IT != m_MusicQueues->end())
+            IT->second->RemoveSong(Name);
+    }
+
+    void CDiscordClient::OnMessageReceive(MessageBase Msg)
+    {
+        switch (Msg->Event)
+        {
+            case QUEUE_NEXT_SONG:
+            {
+                auto Data = std::static_pointer_cast<TMessage<std::string>>(Msg);
 
                 AudioSource Source;
 
@@ -413,618 +1323,1079 @@ namespace DiscordBot
                 }
             }break;
 
+            case CONNECT:
+            {
+                auto Data = std::static_pointer_cast<TMessage<std::weak_ptr<CGatewayShard>>>(Msg);
+                GatewayShard Shard = Data->Value.lock();
+                if(!m_Quit && Shard && !Shard->Retired)
+                    ConnectShard(Shard);
+            }break;
+
             case RESUME:
             {
-                m_Socket.start();
+                auto Data = std::static_pointer_cast<TMessage<std::weak_ptr<CGatewayShard>>>(Msg);
+                GatewayShard Shard = Data->Value.lock();
+                if(!m_Quit && Shard && !Shard->Retired)
+                {
+                    //Closes of the old connection are ignored while the reconnect is pending.
+                    Shard->Socket.stop();
+                    Shard->ReconnectPending = false;
+                    Shard->Socket.setUrl(GetShardURL(Shard.get()));
+                    Shard->Socket.start();
+                }
+            }break;
+
+            case HEARTBEAT_TIMEOUT:
+            {
+                auto Data = std::static_pointer_cast<TMessage<std::weak_ptr<CGatewayShard>>>(Msg);
+                GatewayShard Shard = Data->Value.lock();
+                if(!m_Quit && Shard && !Shard->Retired)
+                    OnHeartbeatTimeout(Shard);
             }break;
 
-            case RECONNECT:
+            case SAVE_CHECKPOINT:
             {
-                m_SessionID.clear();
-                m_Socket.start();
+                if(!m_Quit && !m_Draining)
+                {
+                    SaveCheckpoint();
+                    m_EVManger.PostMessage(SAVE_CHECKPOINT, 0, m_CheckpointInterval);
+                }
             }break;
 
             case QUIT:
             {
                 Quit();
             }break;
+
+            case RELEASE_SHARDS:
+            {
+                ReleaseShards();
+            }break;
+
+            case RESHARD:
+            case RESHARD_TIMEOUT:
+            {
+                auto Data = std::static_pointer_cast<TMessage<uint32_t>>(Msg);
+                SwitchShards(Data->Value, Msg->Event == RESHARD_TIMEOUT);
+            }break;
+
+            case HANDOFF:
+            {
+                Handoff();
+            }break;
         }
     }
 
-    void CDiscordClient::OnWebsocketEvent(const ix::WebSocketMessagePtr &msg)
+    void CDiscordClient::OnWebsocketEvent(CGatewayShard *Shard, const ix::WebSocketMessagePtr &msg)
     {
+        //The shard was replaced by a resharding.
+        if(Shard->Retired)
+            return;
+
+        //Records the raw frames for replays.
+        if(m_Recording && !Shard->Standby)
+        {
+            if(msg->type == ix::WebSocketMessageType::Message)
+                m_Recorder.Write(Shard->ID, msg->binary ? FrameType::BINARY : FrameType::TEXT, msg->str);
+            else if(msg->type == ix::WebSocketMessageType::Open)
+                m_Recorder.Write(Shard->ID, FrameType::OPEN, "");
+            else if(msg->type == ix::WebSocketMessageType::Close)
+                m_Recorder.Write(Shard->ID, FrameType::CLOSE, "");
+        }
+
         switch (msg->type)
         {
             case ix::WebSocketMessageType::Open:
             {
-                llog << linfo << "Websocket opened URI: " << msg->openInfo.uri << " Protocol: " << msg->openInfo.protocol << lendl;
+                //Each connection starts with a new zlib context.
+                if(m_Compress)
+                    Shard->Inflater.Reset();
+
+                Shard->Outbound.OnConnect();
+
+                llog << linfo << "Shard " << Shard->ID << " websocket opened URI: " << msg->openInfo.uri << " Protocol: " << msg->openInfo.protocol << lendl;
             }break;
 
             case ix::WebSocketMessageType::Error:
             {
                 llog << lerror << "Websocket error " << msg->errorInfo.reason << lendl;
+
+                //Failed connection attempts only emit an error.
+                ScheduleReconnect(Shard, !Shard->SessionID->empty());
             }break;
 
             case ix::WebSocketMessageType::Close:
             {
-                m_Terminate = true;
-                m_HeartACKReceived = false;
-                llog << linfo << "Websocket closed code " << msg->closeInfo.code << " Reason " << msg->closeInfo.reason << lendl;
+                Shard->Terminate = true;
+                Shard->HeartACKReceived = false;
+                Shard->Outbound.OnDisconnect();
+                Shard->MemberLoader.Reset();
+                StopHeartbeat(Shard);
+                m_Identifier.Cancel(Shard->ID, Shard->Generation);
+                llog << linfo << "Shard " << Shard->ID << " websocket closed code " << msg->closeInfo.code << " Reason " << msg->closeInfo.reason << lendl;
+
+                switch (msg->closeInfo.code)
+                {
+                    //Reconnecting doesn't fix these errors.
+                    case 4004:  //Authentication failed
+                    case 4010:  //Invalid shard
+                    case 4011:  //Sharding required
+                    case 4012:  //Invalid API version
+                    case 4013:  //Invalid intents
+                    case 4014:  //Disallowed intents
+                    {
+                        llog << lerror << "Shard " << Shard->ID << " can't reconnect. Close code " << msg->closeInfo.code << lendl;
+                    }break;
+
+                    //The session is gone, a new identify is needed.
+                    case 4007:  //Invalid seq
+                    case 4009:  //Session timed out
+                    {
+                        ScheduleReconnect(Shard, false);
+                    }break;
+
+                    default:
+                    {
+                        ScheduleReconnect(Shard, !Shard->SessionID->empty());
+                    }break;
+                }
             }break;
 
             case ix::WebSocketMessageType::Message:
             {
+                const std::string *Data = &msg->str;
+
+                if(m_Compress && msg->binary)
+                {
+                    CZLibStream::Result Res = Shard->Inflater.Feed(msg->str);
+                    if(Res == CZLibStream::Result::NEED_MORE)
+                        return;
+                    else if(Res == CZLibStream::Result::FAILED)
+                    {
+                        //The context can't recover from an error, so we need a new connection.
+                        Shard->Socket.close();
+                        return;
+                    }
+
+                    Data = &Shard->Inflater.GetMessage();
+                }
+
+                //Only the envelope is scanned here, "d" is parsed by the handler of the opcode.
                 CJSON json;
-                SPayload Pay;
+                SEnvelope Env;
 
-                try
+                //The etf envelope is decoded directly. "d" is written as json, so all events share the same model builders.
+                if(m_Encoding == GatewayEncoding::ETF && msg->binary)
                 {
-                    Pay = json.Deserialize<SPayload>(msg->str);
+                    if(!Shard->ETFDecoder.Decode(*Data, Env, Shard->ETFBuffer))
+                    {
+                        llog << lerror << "Failed to decode etf message." << lendl;
+                        return;
+                    }
+
+                    Data = &Shard->ETFBuffer;
                 }
-                catch (const CJSONException &e)
+                else if(!Env.Scan(*Data))
                 {
-                    llog << lerror << "Failed to parse JSON Enumtype: " << GetEnumName(e.GetErrType()) << " what(): " << e.what() << lendl;
+                    llog << lerror << "Failed to scan the payload envelope." << lendl;
                     return;
                 }
 
-                switch ((OPCodes)Pay.OP)
+                switch ((OPCodes)Env.OP)
                 {
                     case OPCodes::DISPATCH:
                     {
-                        m_LastSeqNum = Pay.S;
-                        std::hash<std::string> hash;
+                        Shard->LastSeqNum = Env.S;
+                        Shard->LastDispatch = GetSteadyMillis();
+                        GatewayEvent Event = GetGatewayEvent(Env.T);
 
-                        //Gateway Events https://discordapp.com/developers/docs/topics/gateway#commands-and-events-gateway-events
-                        switch (Adler32(Pay.T.c_str()))
+                        //The current shards still dispatch all events, a standby shard only waits for its guilds.
+                        if(Shard->Standby)
                         {
-                            //Called after the handshake is completed.
-                            case Adler32("READY"):
-                            {
-                                json.ParseObject(Pay.D);
-                                m_SessionID = json.GetValue<std::string>("session_id");
+                            OnStandbyDispatch(Shard, Event, *Data, Env);
+                            break;
+                        }
+
+                        //Nobody uses this event, so it isn't decoded.
+                        if(!IsSubscribed(Event, Env.T))
+                            break;
 
-                                // json.ParseObject();
-                                json.GetValue<std::string>("user") >> m_BotUser >> m_Users;
+                        //The message buffer is reused, so the event gets its own copy of "d".
+                        SPayload Pay = Env.ToPayload(*Data);
 
-                                auto Unavailables = json.GetValue<std::vector<std::string>>("guilds");
-                                for (auto &&e : Unavailables)
+                        //The session events are handled in order with the other opcodes. All other events are processed by the worker of their guild.
+                        if(Event == GatewayEvent::READY || Event == GatewayEvent::RESUMED)
+                            OnDispatch(Shard, Event, Pay);
+                        else
+                        {
+                            //A retired shard is deleted after its queued events.
+                            Shard->QueuedEvents++;
+                            PostEvent(GetEventKey(Event, Pay), [this, Shard, Event, Pay]()
+                            {
+                                try
                                 {
-                                    CJSON tmp;
-                                    tmp.ParseObject(e);
-
-                                    m_Unavailables.push_back(tmp.GetValue<std::string>("id"));
+                                    OnDispatch(Shard, Event, Pay);
                                 }
+                                catch (...)
+                                {
+                                    Shard->QueuedEvents--;
+                                    throw;
+                                }
+
+                                Shard->QueuedEvents--;
+                            });
+                        }
+                    }break;
 
-                                // m_BotUser = CreateUser(json);
+                    case OPCodes::HELLO:
+                    {
+                        try
+                        {
+                            json.ParseObject(Env.GetD(*Data));
+                            Shard->HeartbeatInterval = json.GetValue<uint32_t>("heartbeat_interval");
+                        }
+                        catch (const CJSONException &e)
+                        {
+                            llog << lerror << "Failed to parse JSON Enumtype: " << GetEnumName(e.GetErrType()) << " what(): " << e.what() << lendl;
+                            return;
+                        }
 
-                                llog << linfo << "Connected with Discord! " << m_Socket.getUrl() << lendl;
+                        if (Shard->SessionID->empty())
+                        {
+                            //Inside a cluster the coordinator decides when a shard is allowed to identify.
+                            if(m_Cluster)
+                                m_Cluster->RequestIdentify(Shard->ID, std::bind(&CDiscordClient::SendIdentity, this, Shard));
+                            else
+                                m_Identifier.Request(Shard->ID, std::bind(&CDiscordClient::SendIdentity, this, Shard), Shard->Generation);
+                        }
+                        else
+                            SendResume(Shard);
 
-                                if (m_Controller)
-                                    m_Controller->OnReady();
-                            }
-                            break;
+                        Shard->HeartACKReceived = true;
+                        Shard->Terminate = false;
+                        Shard->HeartbeatSent = 0;
+                        Shard->LastDispatch = GetSteadyMillis();
 
-                            /*------------------------GUILDS Intent------------------------*/
+                        StopHeartbeat(Shard);
+                        Shard->HeartbeatTimer = m_Timer->Schedule(0, std::bind(&CDiscordClient::Heartbeat, this, Shard), Shard->HeartbeatInterval);
+                        Shard->WatchdogTimer = m_Timer->Schedule(WATCHDOG_INTERVAL, std::bind(&CDiscordClient::Watchdog, this, Shard), WATCHDOG_INTERVAL);
+                    }break;
 
-                            case Adler32("GUILD_CREATE"):
-                            {
-                                json.ParseObject(Pay.D);
+                    case OPCodes::HEARTBEAT_ACK:
+                    {
+                        int64_t Sent = Shard->HeartbeatSent;
+                        if(Sent != 0 && !Shard->HeartACKReceived)
+                            Shard->Latency.Add((uint32_t)(GetSteadyMillis() - Sent));
 
-                                Guild guild = Guild(new CGuild());
-                                guild->ID = json.GetValue<std::string>("id");
-                                guild->Name = json.GetValue<std::string>("name");
-                                guild->Icon = json.GetValue<std::string>("icon");
+                        Shard->HeartACKReceived = true;
+                    }break;
 
-                                //Get all Roles;
-                                std::vector<std::string> Array = json.GetValue<std::vector<std::string>>("roles");
-                                for (auto &&e : Array)
-                                {
-                                    Role Tmp;
-                                    e >> Tmp;
-                                    guild->Roles->insert({Tmp->ID, Tmp});
-                                }
+                    //Discord wants a new connection.
+                    case OPCodes::RECONNECT:
+                    {
+                        llog << linfo << "Shard " << Shard->ID << " RECONNECT requested" << lendl;
+                        ScheduleReconnect(Shard, true);
+                    }break;
 
-                                //Get all Channels;
-                                Array = json.GetValue<std::vector<std::string>>("channels");
-                                for (auto &&e : Array)
-                                {
-                                    Channel Tmp;
-                                    (e & m_Users) >> Tmp;
-                                    
-                                    Tmp->GuildID = guild->ID;
-                                    guild->Channels->insert({Tmp->ID, Tmp});
-                                }
+                    //Something is wrong.
+                    case OPCodes::INVALID_SESSION:
+                    {
+                        if (Env.IsD(*Data, "true"))
+                            SendResume(Shard);
+                        else
+                            ScheduleReconnect(Shard, false);
 
-                                //Get all members.
-                                Array = json.GetValue<std::vector<std::string>>("members");
-                                for (auto &&e : Array)
-                                {
-                                    CJSON Member;
-                                    Member.ParseObject(e);
+                        llog << linfo << "INVALID_SESSION" << lendl;
+                    }break;
+                }
+            }break;
+        }
+    }
 
-                                    GuildMember Tmp = CreateMember(Member, guild);
+    void CDiscordClient::OnDispatch(CGatewayShard *Shard, GatewayEvent Event, const SPayload &Pay)
+    {
+        CJSON json;
 
-                                    // if (Tmp->UserRef)
-                                    //     guild->Members[Tmp->UserRef->ID] = Tmp;
-                                }
+        //Raw handlers also receive the events which aren't modeled by the library.
+        std::vector<RawEventHandler> RawHandlers;
+        {
+            std::lock_guard<std::mutex> lock(m_RawHandlersLock);
+            auto IT = m_RawHandlers.find(Pay.T);
+            if(IT != m_RawHandlers.end())
+                RawHandlers = IT->second;
+        }
 
-                                //Get all voice states.
-                                Array = json.GetValue<std::vector<std::string>>("voice_states");
-                                for (auto &&e : Array)
-                                {
-                                    CJSON State;
-                                    State.ParseObject(e);
+        for (auto &&e : RawHandlers)
+            e(Shard->ID, Pay.D);
 
-                                    CreateVoiceState(State, guild);
-                                }
+        switch (Event)
+        {
+            //Called after the handshake is completed.
+            case GatewayEvent::READY:
+            {
+                json.ParseObject(Pay.D);
+                Shard->SessionID = json.GetValue<std::string>("session_id");
+
+                try
+                {
+                    Shard->ResumeURL = json.GetValue<std::string>("resume_gateway_url");
+                }
+                catch (const CJSONException &e)
+                {
+                    //Older gateway versions doesn't send a resume url.
+                    Shard->ResumeURL = "";
+                }
 
-                                //Gets the owner object.
-                                std::string OwnerID = json.GetValue<std::string>("owner_id");
-                                guild->Owner = GetMember(guild, OwnerID);
-                                m_Guilds->insert({guild->ID, guild});
+                //The bot user is read by the event handlers, so it's replaced on their workers.
+                User Bot;
+                json.GetValue<std::string>("user") >> Bot >> m_Users;
+                NotifyController([this, Bot]() { m_BotUser = Bot; });
 
-                                auto IT = std::find(m_Unavailables.begin(), m_Unavailables.end(), guild->ID);
-                                if(IT != m_Unavailables.end())
-                                {
-                                    m_Unavailables.erase(IT);
+                auto Unavailables = json.GetValue<std::vector<std::string>>("guilds");
+                for (auto &&e : Unavailables)
+                {
+                    CJSON tmp;
+                    tmp.ParseObject(e);
 
-                                    if(m_Controller)
-                                        m_Controller->OnGuildAvailable(guild);
-                                }
-                                else if(m_Controller)
-                                    m_Controller->OnGuildJoin(guild);
-                            }break;
+                    Shard->AddUnavailable(tmp.GetValue<std::string>("id"));
+                }
+
+                // m_BotUser = CreateUser(json);
+
+                llog << linfo << "Shard " << Shard->ID << " connected with Discord! " << Shard->Socket.getUrl() << lendl;
+                Shard->Ready = true;
+                Shard->Backoff.Reset();
+                Shard->Outbound.OnReady();
+                Shard->MemberLoader.Start();
+                RejoinVoice(Shard);
+
+                //Waits until all shards are connected.
+                bool AllReady = true;
+                for (auto &&e : m_Shards.load())
+                    AllReady = AllReady && e->Ready;
+
+                if (AllReady)
+                    NotifyController([this]() { if (m_Controller) m_Controller->OnReady(); });
+            }
+            break;
+
+            /*------------------------GUILDS Intent------------------------*/
+
+            case GatewayEvent::GUILD_CREATE:
+            {
+                json.ParseObject(Pay.D);
+
+                //A new guild object replaces a guild of a restored cache.
+                Guild guild = CreateGuild(json);
+                m_Guilds->erase(guild->ID);
+                m_Guilds->insert({guild->ID, guild});
+
+                if(Shard->RemoveUnavailable(guild->ID))
+                {
+                    if(m_Controller)
+                        m_Controller->OnGuildAvailable(guild);
+                }
+                else if(m_Controller)
+                    m_Controller->OnGuildJoin(guild);
+
+                //Large guilds only contain the online members, the others are loaded in chunks.
+                if(json.GetValue<bool>("large") && !m_LazyMembers && ((uint32_t)m_Intents & (uint32_t)Intent::GUILD_MEMBERS))
+                    Shard->MemberLoader.Request(guild->ID);
+            }break;
+
+            case GatewayEvent::GUILD_DELETE:
+            {
+                json.ParseObject(Pay.D);
+
+                //Discord doesn't answer member requests of deleted guilds.
+                std::string GuildID = json.GetValue<std::string>("id");
+                Shard->MemberLoader.Remove(GuildID);
+
+                auto IT = m_Guilds->find(GuildID);
+                if(IT != m_Guilds->end())
+                {
+                    bool Unavailable = json.GetValue<bool>("unavailable");
+
+                    if(Unavailable && m_Controller && Shard->RemoveUnavailable(IT->second->ID))
+                        m_Controller->OnGuildUnavailable(IT->second);
+                    else if(!Unavailable && m_Controller)
+                        m_Controller->OnGuildLeave(IT->second);
+                    else
+                        Shard->AddUnavailable(IT->second->ID);
+
+                    m_VoiceSockets->erase(IT->second->ID);
+                    m_MusicQueues->erase(IT->second->ID);
+                    m_Guilds->erase(IT);
+                }
+
+                llog << linfo << "GUILD_DELETE" << lendl;
+            }break;
+
+            /*------------------------GUILDS Intent------------------------*/
+
+            /*------------------------CHANNEL Intent------------------------*/
+
+            case GatewayEvent::CHANNEL_CREATE:
+            {
+                Channel Tmp;
+                (Pay.D & m_Users) >> Tmp;
+
+                auto IT = m_Guilds->find(Tmp->GuildID);
+                if(IT != m_Guilds->end())
+                    IT->second->Channels->insert({Tmp->ID, Tmp});
+            }break;
+
+            case GatewayEvent::CHANNEL_UPDATE:
+            {
+                Channel Tmp;
+                (Pay.D & m_Users) >> Tmp;
+
+                auto IT = m_Guilds->find(Tmp->GuildID);
+                if(IT != m_Guilds->end())
+                {
+                    IT->second->Channels->erase(Tmp->ID);
+                    IT->second->Channels->insert({Tmp->ID, Tmp});
+                }
+            }break;
+
+            case GatewayEvent::CHANNEL_DELETE:
+            {
+                Channel Tmp;
+                (Pay.D & m_Users) >> Tmp;
+
+                auto IT = m_Guilds->find(Tmp->GuildID);
+                if(IT != m_Guilds->end())
+                    IT->second->Channels->erase(Tmp->ID);
+            }break;
+
+            /*------------------------CHANNEL Intent------------------------*/
+
+            /*------------------------GUILD_MEMBERS Intent------------------------*/
+            //ATTENTION: NEEDS "Server Members Intent" ACTIVATED TO WORK, OTHERWISE THE BOT FAIL TO CONNECT AND A ERROR IS WRITTEN TO THE CONSOLE!!!
+
+            case GatewayEvent::GUILD_MEMBERS_CHUNK:
+            {
+                json.ParseObject(Pay.D);
+
+                auto IT = m_Guilds->find(json.GetValue<std::string>("guild_id"));
+                if(IT != m_Guilds->end())
+                {
+                    Guild guild = IT->second;
+
+                    //Streams the members directly into the guild.
+                    std::vector<std::string> Array = json.GetValue<std::vector<std::string>>("members");
+                    for (auto &&e : Array)
+                    {
+                        CJSON Member;
+                        Member.ParseObject(e);
+
+                        CreateMember(Member, guild);
+                    }
+
+                    uint32_t Index = json.GetValue<uint32_t>("chunk_index");
+                    uint32_t Count = json.GetValue<uint32_t>("chunk_count");
+
+                    if (m_Controller)
+                        m_Controller->OnGuildMembersChunk(guild, Index + 1, Count);
+
+                    if (Shard->MemberLoader.OnChunk(guild->ID, Index, Count) && m_Controller)
+                        m_Controller->OnGuildMembersLoaded(guild);
+                }
+            }break;
+
+            case GatewayEvent::GUILD_MEMBER_ADD:
+            {
+                CJSON Member;
+                Member.ParseObject(Pay.D);
+
+                std::string GuildID = Member.GetValue<std::string>("guild_id");
+
+                auto IT = m_Guilds->find(GuildID);
+                if(IT != m_Guilds->end())
+                {
+                    Guild guild = IT->second;//m_Guilds[GuildID];
+                    GuildMember Tmp = CreateMember(Member, guild);
+
+                    if(m_Controller)
+                        m_Controller->OnMemberAdd(guild, Tmp);
+                }
+                else
+                    llog << ldebug << "Invalid Guild ( " << GuildID << " ) " << lendl;
+            }break;
+
+            case GatewayEvent::GUILD_MEMBER_UPDATE:
+            {
+                json.ParseObject(Pay.D);
+                std::string GuildID = json.GetValue<std::string>("guild_id");
+                std::string Premium = json.GetValue<std::string>("premium_since");
+                std::string Nick = json.GetValue<std::string>("nick");
+                std::vector<std::string> Array = json.GetValue<std::vector<std::string>>("roles");
+
+                json.ParseObject(json.GetValue<std::string>("user"));
+                std::string UserID = json.GetValue<std::string>("id");
+
+                auto GIT = m_Guilds->find(GuildID);
+                if(GIT != m_Guilds->end())
+                {
+                    Guild guild = GIT->second;//m_Guilds[GuildID];
+                    auto IT = guild->Members->find(UserID);
+                    if(IT != guild->Members->end())
+                    {
+                        IT->second->Roles->clear();
+                        for (auto &&e : Array)
+                            IT->second->Roles->push_back(guild->Roles->at(e));                               
+
+                        IT->second->Nick = Nick;
+                        IT->second->PremiumSince = Premium;
+
+                        if(m_Controller)
+                            m_Controller->OnMemberUpdate(guild, IT->second);
+                    } 
+                }
+                else
+                    llog << ldebug << "Invalid Guild ( " << GuildID << " ) " << lendl;
+            }break;
+
+            case GatewayEvent::GUILD_BAN_ADD:
+            case GatewayEvent::GUILD_MEMBER_REMOVE:
+            {
+                json.ParseObject(Pay.D);
+                std::string GuildID = json.GetValue<std::string>("guild_id");
+
+                json.ParseObject(json.GetValue<std::string>("user"));
+                std::string UserID = json.GetValue<std::string>("id");
+
+                auto GIT = m_Guilds->find(GuildID);
+                if(GIT != m_Guilds->end())
+                {
+                    Guild guild = GIT->second;//m_Guilds[GuildID];
+
+                    auto IT = guild->Members->find(UserID);
+                    if(IT != guild->Members->end())
+                    {
+                        GuildMember member = IT->second;
+                        guild->Members->erase(IT);
+
+                        if(m_Controller)
+                            m_Controller->OnMemberRemove(guild, member);
+                    }                                
+
+                    //The users are shared by all workers, so the lookup and the erase need the same lock.
+                    {
+                        auto Users = m_Users.operator->();
+                        auto UIT = Users->find(UserID);
+                        if(UIT != Users->end() && UIT->second.use_count() == 1)
+                            Users->erase(UIT);
+                    }
+                }
+                else
+                    llog << ldebug << "Invalid Guild ( " << GuildID << " ) " << lendl;
+            }break;
+
+            /*------------------------GUILD_MEMBERS Intent------------------------*/
+
+            /*------------------------GUILD_PRESENCES Intent------------------------*/
+            //ATTENTION: NEEDS "Presence Intent" ACTIVATED TO WORK, OTHERWISE THE BOT FAIL TO CONNECT AND A ERROR IS WRITTEN TO THE CONSOLE!!!
+
+            case GatewayEvent::PRESENCE_UPDATE:
+            { 
+                json.ParseObject(Pay.D);
+                bool Notify = HasSubscription(EventSubscription::PRESENCE_UPDATE);
+                User user = m_Users | json.GetValue<std::string>("user");
+
+                if(!json.GetValue<std::string>("game").empty())
+                {
+                    CJSON JGame;
+                    JGame.ParseObject(json.GetValue<std::string>("game"));
+                    user->Game = CreateActivity(JGame);
+                }
+
+                user->State = StrToOnlineState(json.GetValue<std::string>("status"));
+                std::vector<std::string> Acts = json.GetValue<std::vector<std::string>>("activities");
+                for (auto &&e : Acts)
+                {
+                    CJSON JAct;
+                    JAct.ParseObject(e);
+                    user->Activities->push_back(CreateActivity(JAct));
+                }
+
+                CJSON JClientState;
+                JClientState.ParseObject(json.GetValue<std::string>("client_status")); 
+
+                user->Desktop = StrToOnlineState(JClientState.GetValue<std::string>("desktop"));      
+                user->Mobile = StrToOnlineState(JClientState.GetValue<std::string>("mobile"));   
+                user->Web = StrToOnlineState(JClientState.GetValue<std::string>("web"));                      
+
+                //Only the users are updated, if the controller doesn't need the member.
+                auto GIT = m_Guilds->find(json.GetValue<std::string>("guild_id"));
+                if(Notify && GIT != m_Guilds->end())
+                {
+                    auto MIT = GIT->second->Members->find(user->ID);
+                    if(MIT != GIT->second->Members->end())
+                    {
+                        if(m_Controller)
+                            m_Controller->OnPresenceUpdate(GIT->second, MIT->second);
+                    }
+                    else
+                    {
+                        //The update is delivered after the member is loaded.
+                        ResolveMember(GIT->second->ID, user->ID, [this](Guild g, GuildMember Member)
+                        {
+                            if(m_Controller)
+                                m_Controller->OnPresenceUpdate(g, Member);
+                        });
+                    }
+                }
+            }break;
+
+            /*------------------------GUILD_PRESENCES Intent------------------------*/
+
+            /*------------------------GUILD_VOICE_STATES Intent------------------------*/
+
+            case GatewayEvent::VOICE_STATE_UPDATE:
+            {
+                json.ParseObject(Pay.D);
+
+                auto G = m_Guilds->find(json.GetValue<std::string>("guild_id"));
+                if(G == m_Guilds->end())
+                    break;
+
+                //Members which aren't cached are created from the event by CreateVoiceState.
+                Channel c;
+                auto M = G->second->Members->find(json.GetValue<std::string>("user_id"));
+                if(M != G->second->Members->end() && M->second->State)
+                    c = M->second->State->ChannelRef;   //Saves the old channel.
+
+                VoiceState Tmp = CreateVoiceState(json, nullptr);
+
+                if (m_Controller && Tmp->GuildRef)
+                {
+                    if(Tmp->UserRef)
+                    {
+                        if(Tmp->UserRef->ID == m_BotUser->ID && !Tmp->ChannelRef)
+                        {
+                            m_VoiceSockets->erase(Tmp->GuildRef->ID);
+                            m_MusicQueues->erase(Tmp->GuildRef->ID);
+                        }
+
+                        auto IT = Tmp->GuildRef->Members->find(Tmp->UserRef->ID);
+                        if(IT != Tmp->GuildRef->Members->end())
+                        {
+                            m_Controller->OnVoiceStateUpdate(Tmp->GuildRef, IT->second);
 
-                            case Adler32("GUILD_DELETE"):
+                            auto AIT = m_Admins->find(Tmp->GuildRef->ID);
+                            if(AIT != m_Admins->end())
                             {
-                                json.ParseObject(Pay.D);
+                                auto Admin = std::dynamic_pointer_cast<CGuildAdmin>(AIT->second);
 
-                                auto IT = m_Guilds->find(json.GetValue<std::string>("id"));
-                                if(IT != m_Guilds->end())
-                                {
-                                    bool Unavailable = json.GetValue<bool>("unavailable");
-                                    auto InnerIT = std::find(m_Unavailables.begin(), m_Unavailables.end(), IT->second->ID);
-
-                                    if(Unavailable && m_Controller && InnerIT != m_Unavailables.end())
-                                    {
-                                        m_Unavailables.erase(InnerIT);
-                                        m_Controller->OnGuildUnavailable(IT->second);
-                                    }
-                                    else if(!Unavailable && m_Controller)
-                                        m_Controller->OnGuildLeave(IT->second);
-                                    else
-                                        m_Unavailables.push_back(IT->second->ID);
-
-                                    m_VoiceSockets->erase(IT->second->ID);
-                                    m_MusicQueues->erase(IT->second->ID);
-                                    m_Guilds->erase(IT);
-                                }
+                                if(!c)
+                                    c = Tmp->ChannelRef;
+
+                                if(c)
+                                    Admin->OnUserVoiceStateChanged(c, IT->second);
+                            }
+                        }
+                    }
+                }   
+            }break;
 
-                                llog << linfo << "GUILD_DELETE" << lendl;
-                            }break;
+            /*------------------------GUILD_VOICE_STATES Intent------------------------*/
 
-                            /*------------------------GUILDS Intent------------------------*/
+            //Called if your bot joins a voice channel.
+            case GatewayEvent::VOICE_SERVER_UPDATE:
+            {
+                json.ParseObject(Pay.D);
+                Guilds::iterator GIT = m_Guilds->find(json.GetValue<std::string>("guild_id"));
+                if (GIT != m_Guilds->end())
+                {
+                    auto UIT = GIT->second->Members->find(m_BotUser->ID);
+                    if (UIT != GIT->second->Members->end())
+                    {
+                        //A new voice server replaces the old connection, e.g. after a resharding. The playing audio continues on the new one.
+                        AudioSource Playing;
+                        auto VIT = m_VoiceSockets->find(GIT->second->ID);
+                        if (VIT != m_VoiceSockets->end())
+                        {
+                            Playing = VIT->second->DetachSource();
+                            m_VoiceSockets->erase(VIT);
+                        }
 
-                            /*------------------------CHANNEL Intent------------------------*/
+                        VoiceSocket Socket = VoiceSocket(new CVoiceSocket(json, UIT->second->State->SessionID, m_BotUser->ID, m_Timer, m_Runtime ? m_Runtime->Workers : nullptr));
+                        Socket->SetOnSpeakFinish(std::bind(&CDiscordClient::OnSpeakFinish, this, std::placeholders::_1));
+                        m_VoiceSockets->insert({GIT->second->ID, Socket});
 
-                            case Adler32("CHANNEL_CREATE"):
+                        //Creates a music queue for the server.
+                        if(m_QueueFactory)
+                        {
+                            if(m_MusicQueues->find(GIT->second->ID) == m_MusicQueues->end())
                             {
-                                Channel Tmp;
-                                (Pay.D & m_Users) >> Tmp;
+                                MusicQueue MQ = m_QueueFactory->Create();
+                                MQ->SetGuildID(GIT->second->ID);
+                                MQ->SetOnWaitFinishCallback(std::bind(&CDiscordClient::OnQueueWaitFinish, this, std::placeholders::_1, std::placeholders::_2));
+                                m_MusicQueues->insert({GIT->second->ID, MQ});
+                            }
+                        }
 
-                                auto IT = m_Guilds->find(Tmp->GuildID);
-                                if(IT != m_Guilds->end())
-                                    IT->second->Channels->insert({Tmp->ID, Tmp});
-                            }break;
+                        //Plays the queued audiosource.
+                        AudioSources::iterator IT = m_AudioSources->find(GIT->second->ID);
+                        if (Playing)
+                            Socket->StartSpeaking(Playing);
+                        else if (IT != m_AudioSources->end())
+                        {
+                            Socket->StartSpeaking(IT->second);
+                            m_AudioSources->erase(IT);
+                        }
+                    }
+                }
+            }break;
 
-                            case Adler32("CHANNEL_UPDATE"):
-                            {
-                                Channel Tmp;
-                                (Pay.D & m_Users) >> Tmp;
+            /*------------------------GUILD_MESSAGES Intent------------------------*/
 
-                                auto IT = m_Guilds->find(Tmp->GuildID);
-                                if(IT != m_Guilds->end())
-                                {
-                                    IT->second->Channels->erase(Tmp->ID);
-                                    IT->second->Channels->insert({Tmp->ID, Tmp});
-                                }
-                            }break;
+            case GatewayEvent::MESSAGE_CREATE:
+            case GatewayEvent::MESSAGE_UPDATE:
+            {
+                json.ParseObject(Pay.D);
+                Message msg = CreateMessage(json);
 
-                            case Adler32("CHANNEL_DELETE"):
-                            {
-                                Channel Tmp;
-                                (Pay.D & m_Users) >> Tmp;
+                std::shared_ptr<CGuildAdmin> Admin;
+                auto AIT = m_Admins->find(msg->GuildRef->ID);
+                if(AIT != m_Admins->end())
+                    Admin = std::dynamic_pointer_cast<CGuildAdmin>(AIT->second);
 
-                                auto IT = m_Guilds->find(Tmp->GuildID);
-                                if(IT != m_Guilds->end())
-                                    IT->second->Channels->erase(Tmp->ID);
-                            }break;
+                switch (Event)
+                {
+                    case GatewayEvent::MESSAGE_CREATE:
+                    {
+                        if (m_Controller)
+                            m_Controller->OnMessage(msg);
 
-                            /*------------------------CHANNEL Intent------------------------*/
+                        if(Admin)
+                            Admin->OnMessageEvent(ActionType::MESSAGE_CREATED, msg->ChannelRef, msg);
+                    }break;
 
-                            /*------------------------GUILD_MEMBERS Intent------------------------*/
-                            //ATTENTION: NEEDS "Server Members Intent" ACTIVATED TO WORK, OTHERWISE THE BOT FAIL TO CONNECT AND A ERROR IS WRITTEN TO THE CONSOLE!!!
+                    case GatewayEvent::MESSAGE_UPDATE:
+                    {
+                        if (m_Controller)
+                            m_Controller->OnMessageEdited(msg);
 
-                            case Adler32("GUILD_MEMBER_ADD"):
-                            {
-                                CJSON Member;
-                                Member.ParseObject(Pay.D);
+                        if(Admin)
+                            Admin->OnMessageEvent(ActionType::MESSAGE_EDITED, msg->ChannelRef, msg);
+                    }break;
 
-                                std::string GuildID = Member.GetValue<std::string>("guild_id");
+                    default:
+                        break;
+                }
 
-                                auto IT = m_Guilds->find(GuildID);
-                                if(IT != m_Guilds->end())
-                                {
-                                    Guild guild = IT->second;//m_Guilds[GuildID];
-                                    GuildMember Tmp = CreateMember(Member, guild);
+            }break;
 
-                                    if(m_Controller)
-                                        m_Controller->OnMemberAdd(guild, Tmp);
-                                }
-                                else
-                                    llog << ldebug << "Invalid Guild ( " << GuildID << " ) " << lendl;
-                            }break;
+            //Deletes only contain ids, so no full message is created.
+            case GatewayEvent::MESSAGE_DELETE:
+            {
+                json.ParseObject(Pay.D);
+                Message msg = CreatePartialMessage(json.GetValue<std::string>("guild_id"), json.GetValue<std::string>("channel_id"), json.GetValue<std::string>("id"));
 
-                            case Adler32("GUILD_MEMBER_UPDATE"):
-                            {
-                                json.ParseObject(Pay.D);
-                                std::string GuildID = json.GetValue<std::string>("guild_id");
-                                std::string Premium = json.GetValue<std::string>("premium_since");
-                                std::string Nick = json.GetValue<std::string>("nick");
-                                std::vector<std::string> Array = json.GetValue<std::vector<std::string>>("roles");
+                if (m_Controller)
+                    m_Controller->OnMessageDeleted(msg);
 
-                                json.ParseObject(json.GetValue<std::string>("user"));
-                                std::string UserID = json.GetValue<std::string>("id");
+                if(msg->GuildRef)
+                {
+                    auto AIT = m_Admins->find(msg->GuildRef->ID);
+                    if(AIT != m_Admins->end())
+                        std::dynamic_pointer_cast<CGuildAdmin>(AIT->second)->OnMessageEvent(ActionType::MESSAGE_DELETED, msg->ChannelRef, msg);
+                }
+            }break;
 
-                                auto GIT = m_Guilds->find(GuildID);
-                                if(GIT != m_Guilds->end())
-                                {
-                                    Guild guild = GIT->second;//m_Guilds[GuildID];
-                                    auto IT = guild->Members->find(UserID);
-                                    if(IT != guild->Members->end())
-                                    {
-                                        IT->second->Roles->clear();
-                                        for (auto &&e : Array)
-                                            IT->second->Roles->push_back(guild->Roles->at(e));                               
-
-                                        IT->second->Nick = Nick;
-                                        IT->second->PremiumSince = Premium;
-
-                                        if(m_Controller)
-                                            m_Controller->OnMemberUpdate(guild, IT->second);
-                                    } 
-                                }
-                                else
-                                    llog << ldebug << "Invalid Guild ( " << GuildID << " ) " << lendl;
-                            }break;
+            case GatewayEvent::MESSAGE_DELETE_BULK:
+            {
+                json.ParseObject(Pay.D);
+                Message msg = CreatePartialMessage(json.GetValue<std::string>("guild_id"), json.GetValue<std::string>("channel_id"), "");
+                std::vector<std::string> IDs = json.GetValue<std::vector<std::string>>("ids");
 
-                            case Adler32("GUILD_BAN_ADD"):
-                            case Adler32("GUILD_MEMBER_REMOVE"):
-                            {
-                                json.ParseObject(Pay.D);
-                                std::string GuildID = json.GetValue<std::string>("guild_id");
+                if (m_Controller)
+                    m_Controller->OnMessagesDeleted(msg->ChannelRef, IDs);
 
-                                json.ParseObject(json.GetValue<std::string>("user"));
-                                std::string UserID = json.GetValue<std::string>("id");
+                if(msg->GuildRef)
+                {
+                    auto AIT = m_Admins->find(msg->GuildRef->ID);
+                    if(AIT != m_Admins->end())
+                        std::dynamic_pointer_cast<CGuildAdmin>(AIT->second)->OnMessagesDeleted(msg->ChannelRef, IDs);
+                }
+            }break;
 
-                                auto GIT = m_Guilds->find(GuildID);
-                                if(GIT != m_Guilds->end())
-                                {
-                                    Guild guild = GIT->second;//m_Guilds[GuildID];
-
-                                    auto IT = guild->Members->find(UserID);
-                                    if(IT != guild->Members->end())
-                                    {
-                                        GuildMember member = IT->second;
-                                        guild->Members->erase(IT);
-
-                                        if(m_Controller)
-                                            m_Controller->OnMemberRemove(guild, member);
-                                    }                                
-
-                                    if(m_Users->find(UserID) != m_Users->end())
-                                    {
-                                        if(m_Users->at(UserID).use_count() == 1)
-                                            m_Users->erase(UserID);
-                                    }
-                                }
-                                else
-                                    llog << ldebug << "Invalid Guild ( " << GuildID << " ) " << lendl;
-                            }break;
+            /*------------------------GUILD_MESSAGES Intent------------------------*/
 
-                            /*------------------------GUILD_MEMBERS Intent------------------------*/
+            //Called if a session resumed.
+            case GatewayEvent::RESUMED:
+            {
+                llog << linfo << "Shard " << Shard->ID << " resumed" << lendl;
+                Shard->Backoff.Reset();
+                Shard->Outbound.OnReady();
+                Shard->MemberLoader.Start();
+                RejoinVoice(Shard);
+
+                //Sessions of the checkpoint are resumed without a READY event.
+                if(!Shard->Ready)
+                {
+                    Shard->Ready = true;
 
-                            /*------------------------GUILD_PRESENCES Intent------------------------*/
-                            //ATTENTION: NEEDS "Presence Intent" ACTIVATED TO WORK, OTHERWISE THE BOT FAIL TO CONNECT AND A ERROR IS WRITTEN TO THE CONSOLE!!!
+                    bool AllReady = true;
+                    for (auto &&e : m_Shards.load())
+                        AllReady = AllReady && e->Ready;
 
-                            case Adler32("PRESENCE_UPDATE"):
-                            { 
-                                json.ParseObject(Pay.D);
-                                User user = m_Users | json.GetValue<std::string>("user");
+                    if (AllReady)
+                        NotifyController([this]() { if (m_Controller) m_Controller->OnReady(); });
+                }
+                else
+                    NotifyController([this]() { if (m_Controller) m_Controller->OnResume(); });
+            } break;
 
-                                if(!json.GetValue<std::string>("game").empty())
-                                {
-                                    CJSON JGame;
-                                    JGame.ParseObject(json.GetValue<std::string>("game"));
-                                    user->Game = CreateActivity(JGame);
-                                }
+            //Events which aren't modeled are only passed to the raw handlers.
+            default:
+                break;
+        }
+    }
 
-                                user->State = StrToOnlineState(json.GetValue<std::string>("status"));
-                                std::vector<std::string> Acts = json.GetValue<std::vector<std::string>>("activities");
-                                for (auto &&e : Acts)
-                                {
-                                    CJSON JAct;
-                                    JAct.ParseObject(e);
-                                    user->Activities->push_back(CreateActivity(JAct));
-                                }
+    std::string CDiscordClient::GetEventKey(GatewayEvent Event, const SPayload &Pay)
+    {
+        //Only the top level is scanned, the handler parses the event.
+        CJSONScanner Scanner(Pay.D);
+        SJSONRange Value;
+        bool Found = false;
 
-                                CJSON JClientState;
-                                JClientState.ParseObject(json.GetValue<std::string>("client_status")); 
+        switch (Event)
+        {
+            //The guild object contains the guild id as id.
+            case GatewayEvent::GUILD_CREATE:
+            case GatewayEvent::GUILD_UPDATE:
+            case GatewayEvent::GUILD_DELETE:
+                Found = Scanner.Find("id", Value);
+                break;
 
-                                user->Desktop = StrToOnlineState(JClientState.GetValue<std::string>("desktop"));      
-                                user->Mobile = StrToOnlineState(JClientState.GetValue<std::string>("mobile"));   
-                                user->Web = StrToOnlineState(JClientState.GetValue<std::string>("web"));                      
+            default:
+                Found = Scanner.Find("guild_id", Value);
+                break;
+        }
 
-                                auto GIT = m_Guilds->find(json.GetValue<std::string>("guild_id"));
-                                if(GIT != m_Guilds->end())
-                                {
-                                    GuildMember member;
-                                    auto MIT = GIT->second->Members->find(user->ID);
-                                    if(MIT == GIT->second->Members->end())
-                                        member = GetMember(GIT->second, user->ID);
-                                    else
-                                        member = MIT->second;
-
-                                    if(m_Controller)
-                                        m_Controller->OnPresenceUpdate(GIT->second, member);
-                                }
-                            }break;
+        //Events without guild, e.g. direct messages.
+        if(!Found || Pay.D[Value.Pos] != '"')
+            return "";
 
-                            /*------------------------GUILD_PRESENCES Intent------------------------*/
+        return Scanner.GetString(Value);
+    }
 
-                            /*------------------------GUILD_VOICE_STATES Intent------------------------*/
+    bool CDiscordClient::IsSubscribed(GatewayEvent Event, const std::string &Name)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_RawHandlersLock);
+            if(m_RawHandlers.find(Name) != m_RawHandlers.end())
+                return true;
+        }
 
-                            case Adler32("VOICE_STATE_UPDATE"):
-                            {
-                                json.ParseObject(Pay.D);
+        switch (Event)
+        {
+            //Events which are always processed, because they update the cache.
+            case GatewayEvent::READY:
+            case GatewayEvent::RESUMED:
+            case GatewayEvent::GUILD_CREATE:
+            case GatewayEvent::GUILD_DELETE:
+            case GatewayEvent::CHANNEL_CREATE:
+            case GatewayEvent::CHANNEL_UPDATE:
+            case GatewayEvent::CHANNEL_DELETE:
+            case GatewayEvent::GUILD_MEMBERS_CHUNK:
+            case GatewayEvent::GUILD_MEMBER_ADD:
+            case GatewayEvent::GUILD_MEMBER_UPDATE:
+            case GatewayEvent::GUILD_MEMBER_REMOVE:
+            case GatewayEvent::GUILD_BAN_ADD:
+            case GatewayEvent::VOICE_STATE_UPDATE:
+            case GatewayEvent::VOICE_SERVER_UPDATE:
+            case GatewayEvent::MESSAGE_CREATE:
+                return true;
+
+            case GatewayEvent::PRESENCE_UPDATE:
+                return HasSubscription(EventSubscription::PRESENCE_UPDATE | EventSubscription::USER_PRESENCE);
+
+            //The guild admins also use message events.
+            case GatewayEvent::MESSAGE_UPDATE:
+                return HasSubscription(EventSubscription::MESSAGE_EDITED) || !m_Admins->empty();
+
+            case GatewayEvent::MESSAGE_DELETE:
+            case GatewayEvent::MESSAGE_DELETE_BULK:
+                return HasSubscription(EventSubscription::MESSAGE_DELETED) || !m_Admins->empty();
+
+            //No model for this event.
+            default:
+                return false;
+        }
+    }
 
-                                auto G = m_Guilds->find(json.GetValue<std::string>("guild_id"));
-                                auto M = G->second->Members->find(json.GetValue<std::string>("user_id"));
-                                Channel c;
-                                if(M->second->State)
-                                    c = M->second->State->ChannelRef;   //Saves the old channel.
+    bool CDiscordClient::HasSubscription(EventSubscription Sub)
+    {
+        //Without a controller the behavior is the same as before.
+        if(!m_Controller)
+            return true;
 
-                                VoiceState Tmp = CreateVoiceState(json, nullptr);
+        return (m_Controller->GetSubscriptions() & Sub) != EventSubscription::NONE;
+    }
 
-                                if (m_Controller && Tmp->GuildRef)
-                                {
-                                    if(Tmp->UserRef)
-                                    {
-                                        if(Tmp->UserRef->ID == m_BotUser->ID && !Tmp->ChannelRef)
-                                        {
-                                            m_VoiceSockets->erase(Tmp->GuildRef->ID);
-                                            m_MusicQueues->erase(Tmp->GuildRef->ID);
-                                        }
-
-                                        auto IT = Tmp->GuildRef->Members->find(Tmp->UserRef->ID);
-                                        if(IT != Tmp->GuildRef->Members->end())
-                                        {
-                                            m_Controller->OnVoiceStateUpdate(Tmp->GuildRef, IT->second);
-
-                                            auto AIT = m_Admins->find(Tmp->GuildRef->ID);
-                                            if(AIT != m_Admins->end())
-                                            {
-                                                auto Admin = std::dynamic_pointer_cast<CGuildAdmin>(AIT->second);
-
-                                                if(!c)
-                                                    c = Tmp->ChannelRef;
-                                                    
-                                                if(c)
-                                                    Admin->OnUserVoiceStateChanged(c, IT->second);
-                                            }
-                                        }
-                                    }
-                                }   
-                            }break;
-
-                            /*------------------------GUILD_VOICE_STATES Intent------------------------*/
-
-                            //Called if your bot joins a voice channel.
-                            case Adler32("VOICE_SERVER_UPDATE"):
-                            {
-                                json.ParseObject(Pay.D);
-                                Guilds::iterator GIT = m_Guilds->find(json.GetValue<std::string>("guild_id"));
-                                if (GIT != m_Guilds->end())
-                                {
-                                    auto UIT = GIT->second->Members->find(m_BotUser->ID);
-                                    if (UIT != GIT->second->Members->end())
-                                    {
-                                        VoiceSocket Socket = VoiceSocket(new CVoiceSocket(json, UIT->second->State->SessionID, m_BotUser->ID));
-                                        Socket->SetOnSpeakFinish(std::bind(&CDiscordClient::OnSpeakFinish, this, std::placeholders::_1));
-                                        m_VoiceSockets->insert({GIT->second->ID, Socket});
-
-                                        //Creates a music queue for the server.
-                                        if(m_QueueFactory)
-                                        {
-                                            if(m_MusicQueues->find(GIT->second->ID) == m_MusicQueues->end())
-                                            {
-                                                MusicQueue MQ = m_QueueFactory->Create();
-                                                MQ->SetGuildID(GIT->second->ID);
-                                                MQ->SetOnWaitFinishCallback(std::bind(&CDiscordClient::OnQueueWaitFinish, this, std::placeholders::_1, std::placeholders::_2));
-                                                m_MusicQueues->insert({GIT->second->ID, MQ});
-                                            }
-                                        }
-
-                                        //Plays the queued audiosource.
-                                        AudioSources::iterator IT = m_AudioSources->find(GIT->second->ID);
-                                        if (IT != m_AudioSources->end())
-                                        {
-                                            Socket->StartSpeaking(IT->second);
-                                            m_AudioSources->erase(IT);
-                                        }
-                                    }
-                                }
-                            }break;
+    void CDiscordClient::Heartbeat(CGatewayShard *Shard)
+    {
+        if (Shard->Terminate || m_Replay)
+            return;
 
-                            /*------------------------GUILD_MESSAGES Intent------------------------*/
+        //Start a reconnect. Closing the socket blocks, so this isn't done on the timer thread.
+        if (!Shard->HeartACKReceived)
+        {
+            Shard->Terminate = true;
+            StopHeartbeat(Shard);
+            m_EVManger.PostMessage(HEARTBEAT_TIMEOUT, std::weak_ptr<CGatewayShard>(Shard->shared_from_this()));
+            return;
+        }
 
-                            case Adler32("MESSAGE_CREATE"):
-                            case Adler32("MESSAGE_UPDATE"):
-                            case Adler32("MESSAGE_DELETE"):
-                            {
-                                json.ParseObject(Pay.D);
-                                Message msg = CreateMessage(json);
+        Shard->HeartACKReceived = false;
+        Shard->HeartbeatSent = GetSteadyMillis();
+        SendOP(Shard, OPCodes::HEARTBEAT, Shard->LastSeqNum != CGatewayShard::NO_SEQUENCE ? std::to_string(Shard->LastSeqNum) : "");
+    }
 
-                                std::shared_ptr<CGuildAdmin> Admin;
-                                auto AIT = m_Admins->find(msg->GuildRef->ID);
-                                if(AIT != m_Admins->end())
-                                    Admin = std::dynamic_pointer_cast<CGuildAdmin>(AIT->second);
+    void CDiscordClient::Watchdog(CGatewayShard *Shard)
+    {
+        if (Shard->Terminate || m_Replay)
+            return;
 
-                                switch (Adler32(Pay.T.c_str()))
-                                {
-                                    case Adler32("MESSAGE_CREATE"):
-                                    {
-                                        if (m_Controller)
-                                            m_Controller->OnMessage(msg);
-
-                                        if(Admin)
-                                            Admin->OnMessageEvent(ActionType::MESSAGE_CREATED, msg->ChannelRef, msg);
-                                    }break;
-
-                                    case Adler32("MESSAGE_UPDATE"):
-                                    {
-                                        if (m_Controller)
-                                            m_Controller->OnMessageEdited(msg);
-
-                                        if(Admin)
-                                            Admin->OnMessageEvent(ActionType::MESSAGE_EDITED, msg->ChannelRef, msg);
-                                    }break;
-
-                                    case Adler32("MESSAGE_DELETE"):
-                                    {
-                                        if (m_Controller)
-                                            m_Controller->OnMessageDeleted(msg);
-
-                                        if(Admin)
-                                            Admin->OnMessageEvent(ActionType::MESSAGE_DELETED, msg->ChannelRef, msg);
-                                    }break;
-                                }
+        int64_t Now = GetSteadyMillis();
+        int64_t Sent = Shard->HeartbeatSent;
 
-                            }break;
+        //The ack is overdue long before the next heartbeat would notice it.
+        int64_t AckTimeout = std::min<int64_t>(std::max<int64_t>(ACK_TIMEOUT_FACTOR * Shard->Latency.GetP99(), MIN_ACK_TIMEOUT), Shard->HeartbeatInterval / 2);
+        bool Zombie = false;
 
-                            /*------------------------GUILD_MESSAGES Intent------------------------*/
+        if (Sent != 0 && !Shard->HeartACKReceived && Now - Sent > AckTimeout)
+        {
+            llog << linfo << "Shard " << Shard->ID << " heartbeat ack is missing for " << (Now - Sent) << " ms" << lendl;
+            Zombie = true;
+        }
+        else if (m_DispatchTimeout != 0 && Shard->Ready && Now - Shard->LastDispatch > m_DispatchTimeout)
+        {
+            llog << linfo << "Shard " << Shard->ID << " received no event for " << (Now - Shard->LastDispatch) << " ms" << lendl;
+            Zombie = true;
+        }
 
-                            //Called if a session resumed.
-                            case Adler32("RESUMED"):
-                            {
-                                llog << linfo << "Resumed" << lendl;
+        //Same as a missed heartbeat, the session is resumed.
+        if (Zombie)
+        {
+            Shard->Terminate = true;
+            StopHeartbeat(Shard);
+            m_EVManger.PostMessage(HEARTBEAT_TIMEOUT, std::weak_ptr<CGatewayShard>(Shard->shared_from_this()));
+        }
+    }
 
-                                if (m_Controller)
-                                    m_Controller->OnResume();
-                            } break;
-                        }
-                }break;
+    void CDiscordClient::StopHeartbeat(CGatewayShard *Shard)
+    {
+        m_Timer->Cancel(Shard->HeartbeatTimer);
+        m_Timer->Cancel(Shard->WatchdogTimer);
+    }
 
-                case OPCodes::HELLO:
-                {
-                    try
-                    {
-                        json.ParseObject(Pay.D);
-                        m_HeartbeatInterval = json.GetValue<uint32_t>("heartbeat_interval");
-                    }
-                    catch (const CJSONException &e)
-                    {
-                        llog << lerror << "Failed to parse JSON Enumtype: " << GetEnumName(e.GetErrType()) << " what(): " << e.what() << lendl;
-                        return;
-                    }
+    void CDiscordClient::OnHeartbeatTimeout(GatewayShard Shard)
+    {
+        Shard->Socket.stop();
 
-                    if (m_SessionID.empty())
-                        SendIdentity();
-                    else
-                        SendResume();
+        // m_Users->clear();
+        // m_Guilds->clear();
 
-                    m_HeartACKReceived = true;
-                    m_Terminate = false;
+        //Removes all voice connections of this shard. The guilds of a standby shard are still served by the current shards.
+        if(!Shard->Standby)
+        {
+            auto VoiceSockets = m_VoiceSockets.operator->();
+            auto IT = VoiceSockets->begin();
+            while (IT != VoiceSockets->end())
+            {
+                if(CGatewayShard::GetShardID(IT->first, Shard->Count) == Shard->ID)
+                    IT = VoiceSockets->erase(IT);
+                else
+                    IT++;
+            }
+        }
 
-                    if (m_Heartbeat.joinable())
-                        m_Heartbeat.join();
+        if(!Shard->Standby)
+            NotifyController([this]() { if (m_Controller) m_Controller->OnDisconnect(); });
 
-                    m_Heartbeat = std::thread(&CDiscordClient::Heartbeat, this);
-                }break;
+        ScheduleReconnect(Shard.get(), true);
+    }
 
-                case OPCodes::HEARTBEAT_ACK:
-                {
-                    m_HeartACKReceived = true;
-                }break;
+    void CDiscordClient::ScheduleReconnect(CGatewayShard *Shard, bool Resumable)
+    {
+        if(m_Quit || m_Replay)
+            return;
 
-                //Something is wrong.
-                case OPCodes::INVALID_SESSION:
-                {
-                    if (Pay.D == "true")
-                        SendResume();
-                    else
-                    {
-                        //TODO: Maybe deadlock. Let's find out.
-                        llog << linfo << "INVALID_SESSION CLOSE SOCKET" << lendl;
-                        m_Socket.close();
-                        llog << linfo << "INVALID_SESSION SOCKET CLOSED" << lendl;
-                        m_EVManger.PostMessage(RECONNECT, 0, 5000);
-                    }
-                        //Quit();
+        //Close and error events can both report the same failure.
+        if(Shard->ReconnectPending.exchange(true))
+            return;
 
-                    llog << linfo << "INVALID_SESSION" << lendl;
-                }break;
-                }
-            }break;
+        if(!Resumable)
+        {
+            Shard->SessionID = "";
+            Shard->ResumeURL = "";
         }
+
+        uint32_t Delay = Shard->Backoff.Next(Resumable);
+        llog << linfo << "Shard " << Shard->ID << (Resumable ? " resumes" : " reconnects") << " in " << Delay << " ms" << lendl;
+        m_EVManger.PostMessage(RESUME, std::weak_ptr<CGatewayShard>(Shard->shared_from_this()), Delay);
     }
 
-    void CDiscordClient::Heartbeat()
+    void CDiscordClient::SendOP(CGatewayShard *Shard, CDiscordClient::OPCodes OP, const std::string &D)
     {
-        while (!m_Terminate)
+        if(m_Replay)
+            return;
+
+        SPayload Pay;
+        Pay.OP = (uint32_t)OP;
+        Pay.D = D;
+
+        SendLane Lane;
+        switch (OP)
         {
-            //Start a reconnect.
-            if (!m_HeartACKReceived)
+            case OPCodes::HEARTBEAT:
+            case OPCodes::IDENTIFY:
+            case OPCodes::RESUME:
             {
-                m_Socket.stop();
+                Lane = SendLane::CONTROL;
+            }break;
 
-                // m_Users->clear();
-                // m_Guilds->clear();
+            case OPCodes::VOICE_STATE_UPDATE:
+            {
+                Lane = SendLane::VOICE;
+            }break;
 
-                m_VoiceSockets->clear();
+            case OPCodes::PRESENCE_UPDATE:
+            {
+                Lane = SendLane::PRESENCE;
+            }break;
 
-                if (m_Controller)
-                    m_Controller->OnDisconnect();
+            default:
+            {
+                Lane = SendLane::DEFAULT;
+            }break;
+        }
 
-                m_Terminate = true;
-                m_EVManger.PostMessage(RESUME, 0, 100);
+        //The envelope is written directly, no json message is built.
+        if(m_Encoding == GatewayEncoding::ETF)
+        {
+            CETFEncoder Encoder;
+            std::string Binary;
 
-                break;
+            if(!Encoder.Encode(Pay.OP, Pay.D, Binary))
+            {
+                llog << lerror << "Failed to encode the Payload object as etf." << lendl;
+                return;
             }
 
-            SendOP(OPCodes::HEARTBEAT, m_LastSeqNum != -1 ? std::to_string(m_LastSeqNum) : "");
-            m_HeartACKReceived = false;
-
-            // Terminateable timeout.
-            int64_t Beg = GetTimeMillis();
-            while (((GetTimeMillis() - Beg) < m_HeartbeatInterval) && !m_Terminate)
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
-
-            // std::this_thread::sleep_for(std::chrono::milliseconds(m_HeartbeatInterval));
+            Shard->Outbound.Push(Lane, Binary, true);
+            return;
         }
-    }
-
-    void CDiscordClient::SendOP(CDiscordClient::OPCodes OP, const std::string &D)
-    {
-        SPayload Pay;
-        Pay.OP = (uint32_t)OP;
-        Pay.D = D;
 
         try
         {
             CJSON json;
-            std::string TT = json.Serialize(Pay);
-            m_Socket.send(json.Serialize(Pay));
+            Shard->Outbound.Push(Lane, json.Serialize(Pay), false);
         }
         catch (const CJSONException &e)
         {
@@ -1032,7 +2403,7 @@ namespace DiscordBot
         }
     }
 
-    void CDiscordClient::SendIdentity()
+    void CDiscordClient::SendIdentity(CGatewayShard *Shard)
     {
         SIdentify id;
         id.Token = m_Token;
@@ -1041,20 +2412,23 @@ namespace DiscordBot
         id.Properties["$device"] = "libDiscordBot";
         id.Properties["presence"] = CreateUserInfoJSON();
         id.Intents = m_Intents;
+        id.ShardID = Shard->ID;
+        id.ShardCount = Shard->Count;
+        id.LargeThreshold = m_LargeThreshold;
 
         CJSON json;
-        SendOP(OPCodes::IDENTIFY, json.Serialize(id));
+        SendOP(Shard, OPCodes::IDENTIFY, json.Serialize(id));
     }
 
-    void CDiscordClient::SendResume()
+    void CDiscordClient::SendResume(CGatewayShard *Shard)
     {
         SResume resume;
         resume.Token = m_Token;
-        resume.SessionID = m_SessionID;
-        resume.Seq = m_LastSeqNum;
+        resume.SessionID = Shard->SessionID;
+        resume.Seq = Shard->LastSeqNum;
 
         CJSON json;
-        SendOP(OPCodes::RESUME, json.Serialize(resume));
+        SendOP(Shard, OPCodes::RESUME, json.Serialize(resume));
     }
 
     void CDiscordClient::OnSpeakFinish(const std::string &Guild)
@@ -1065,7 +2439,10 @@ namespace DiscordBot
 
             auto IT = m_Guilds->find(Guild);
             if(IT != m_Guilds->end())
-                m_Controller->OnEndSpeaking(IT->second);
+            {
+                auto Tmp = IT->second;
+                NotifyController([this, Tmp]() { if (m_Controller) m_Controller->OnEndSpeaking(Tmp); }, Tmp->ID);
+            }
         }
     }
 
@@ -1077,7 +2454,7 @@ namespace DiscordBot
         args->extraHeaders["Authorization"] = "Bot " + m_Token;
         args->extraHeaders["User-Agent"] = USER_AGENT;
 
-        return m_HTTPClient.get(std::string(BASE_URL) + URL, args);
+        return m_HTTPClient->get(m_BaseURL + URL, args);
     }
 
     ix::HttpResponsePtr CDiscordClient::Post(const std::string &URL, const std::string &Body)
@@ -1089,7 +2466,7 @@ namespace DiscordBot
         args->extraHeaders["Content-Type"] = "application/json";
         args->extraHeaders["User-Agent"] = USER_AGENT;
 
-        return m_HTTPClient.post(std::string(BASE_URL) + URL, Body, args);
+        return m_HTTPClient->post(m_BaseURL + URL, Body, args);
     }
 
     ix::HttpResponsePtr CDiscordClient::Put(const std::string &URL, const std::string &Body)
@@ -1101,7 +2478,7 @@ namespace DiscordBot
         args->extraHeaders["Content-Type"] = "application/json";
         args->extraHeaders["User-Agent"] = USER_AGENT;
 
-        return m_HTTPClient.put(std::string(BASE_URL) + URL, Body, args);
+        return m_HTTPClient->put(m_BaseURL + URL, Body, args);
     }
 
     ix::HttpResponsePtr CDiscordClient::Patch(const std::string &URL, const std::string &Body)
@@ -1113,7 +2490,7 @@ namespace DiscordBot
         args->extraHeaders["Content-Type"] = "application/json";
         args->extraHeaders["User-Agent"] = USER_AGENT;
 
-        return m_HTTPClient.patch(std::string(BASE_URL) + URL, Body, args);
+        return m_HTTPClient->patch(m_BaseURL + URL, Body, args);
     }
 
     ix::HttpResponsePtr CDiscordClient::Delete(const std::string &URL, const std::string &Body)
@@ -1127,10 +2504,10 @@ namespace DiscordBot
         if(Body != "")
         {
             args->extraHeaders["Content-Type"] = "application/json";
-            return m_HTTPClient.request(std::string(BASE_URL) + URL, "DELETE", Body, args);
+            return m_HTTPClient->request(m_BaseURL + URL, "DELETE", Body, args);
         }
         else
-            return m_HTTPClient.del(std::string(BASE_URL) + URL, args);
+            return m_HTTPClient->del(m_BaseURL + URL, args);
     }
 
     void CDiscordClient::OnQueueWaitFinish(const std::string &Guild, AudioSource Source)
@@ -1250,6 +2627,142 @@ namespace DiscordBot
         return Ret;
     }
 
+    void CDiscordClient::ResolveMember(const std::string &GuildID, const std::string &UserID, MemberCallback Callback)
+    {
+        if(m_Replay || !m_Lookups || UserID.empty())
+            return;
+
+        std::string Key = GuildID + ":" + UserID;
+        {
+            std::lock_guard<std::mutex> lock(m_LookupsLock);
+            auto &Callbacks = m_PendingLookups[Key];
+            Callbacks.push_back(Callback);
+
+            //The member is already requested.
+            if(Callbacks.size() > 1)
+                return;
+        }
+
+        m_Lookups->Post(GuildID, [this, GuildID, UserID, Key]()
+        {
+            std::string Body;
+            auto res = Get("/guilds/" + GuildID + "/members/" + UserID);
+            if (res->statusCode != 200)
+                llog << lerror << "Failed to receive member info HTTP: " << res->statusCode << " MSG: " << res->errorMsg << lendl;
+            else
+                Body = res->body;
+
+            //The cache of a guild is only changed by the worker of the guild.
+            PostEvent(GuildID, [this, GuildID, Key, Body]()
+            {
+                std::vector<MemberCallback> Callbacks;
+                {
+                    std::lock_guard<std::mutex> lock(m_LookupsLock);
+                    auto IT = m_PendingLookups.find(Key);
+                    if(IT != m_PendingLookups.end())
+                    {
+                        Callbacks = std::move(IT->second);
+                        m_PendingLookups.erase(IT);
+                    }
+                }
+
+                //The guild object could be replaced since the request, so the current one is used.
+                auto GIT = m_Guilds->find(GuildID);
+                if(Body.empty() || GIT == m_Guilds->end())
+                    return;
+
+                GuildMember Member;
+                try
+                {
+                    CJSON json;
+                    json.ParseObject(Body);
+
+                    Member = CreateMember(json, GIT->second);
+                }
+                catch (const CJSONException &e)
+                {
+                    llog << lerror << "Failed to parse member JSON Enumtype: " << GetEnumName(e.GetErrType()) << " what(): " << e.what() << lendl;
+                    return;
+                }
+
+                for (auto &&e : Callbacks)
+                {
+                    if(e)
+                        e(GIT->second, Member);
+                }
+
+                if(m_Controller)
+                    m_Controller->OnMemberResolved(GIT->second, Member);
+            });
+        });
+    }
+
+    Guild CDiscordClient::CreateGuild(CJSON &json)
+    {
+        Guild guild = Guild(new CGuild());
+        guild->ID = json.GetValue<std::string>("id");
+        guild->Name = json.GetValue<std::string>("name");
+        guild->Icon = json.GetValue<std::string>("icon");
+
+        //Get all Roles;
+        std::vector<std::string> Array = json.GetValue<std::vector<std::string>>("roles");
+        for (auto &&e : Array)
+        {
+            Role Tmp;
+            e >> Tmp;
+            guild->Roles->insert({Tmp->ID, Tmp});
+        }
+
+        //Get all Channels;
+        Array = json.GetValue<std::vector<std::string>>("channels");
+        for (auto &&e : Array)
+        {
+            Channel Tmp;
+            (e & m_Users) >> Tmp;
+
+            Tmp->GuildID = guild->ID;
+            guild->Channels->insert({Tmp->ID, Tmp});
+        }
+
+        std::string OwnerID = json.GetValue<std::string>("owner_id");
+        guild->OwnerID = OwnerID;
+
+        //Get all members. Large guilds only contain the online members, the others are loaded in chunks or on demand.
+        Array = json.GetValue<std::vector<std::string>>("members");
+        for (auto &&e : Array)
+        {
+            CJSON Member;
+            Member.ParseObject(e);
+
+            CreateMember(Member, guild);
+        }
+
+        //Get all voice states.
+        Array = json.GetValue<std::vector<std::string>>("voice_states");
+        for (auto &&e : Array)
+        {
+            CJSON State;
+            State.ParseObject(e);
+
+            CreateVoiceState(State, guild);
+        }
+
+        //Gets the owner object. A missing owner is loaded in the background, so the guild is available right away.
+        auto OIT = guild->Members->find(OwnerID);
+        if(OIT != guild->Members->end())
+            guild->Owner = OIT->second;
+        else
+        {
+            ResolveMember(guild->ID, OwnerID, [](Guild g, GuildMember Member)
+            {
+                if(Member->UserRef && g->OwnerID == Member->UserRef->ID)
+                    g->Owner = Member;
+            });
+        }
+
+        return guild;
+    }
+
     GuildMember CDiscordClient::CreateMember(CJSON &json, Guild guild)
     {
         GuildMember Ret = GuildMember(new CGuildMember());
@@ -1321,6 +2834,8 @@ namespace DiscordBot
                     JMember.ParseObject(json.GetValue<std::string>("member"));
 
                     Member = CreateMember(JMember, Ret->GuildRef);
+                    if(!Ret->UserRef && Member)
+                        Ret->UserRef = Member->UserRef;
                 }
                 catch (const CJSONException &e)
                 {
@@ -1352,28 +2867,7 @@ namespace DiscordBot
 
     Message CDiscordClient::CreateMessage(CJSON &json)
     {
-        Message Ret = Message(new CMessage());
-        Channel channel;
-
-        Guilds::iterator IT = m_Guilds->find(json.GetValue<std::string>("guild_id"));
-        if (IT != m_Guilds->end())
-        {
-            Ret->GuildRef = IT->second;
-            std::map<std::string, Channel>::iterator CIT = Ret->GuildRef->Channels->find(json.GetValue<std::string>("channel_id"));
-            if (CIT != Ret->GuildRef->Channels->end())
-                channel = CIT->second;
-        }
-
-        //Creates a dummy object for DMs.
-        if (!channel)
-        {
-            channel = Channel(new CChannel());
-            channel->ID = json.GetValue<std::string>("channel_id");
-            channel->Type = ChannelTypes::DM;
-        }
-
-        Ret->ID = json.GetValue<std::string>("id");
-        Ret->ChannelRef = channel;
+        Message Ret = CreatePartialMessage(json.GetValue<std::string>("guild_id"), json.GetValue<std::string>("channel_id"), json.GetValue<std::string>("id"));
 
         std::string UserJson = json.GetValue<std::string>("author");
         if (!UserJson.empty())
@@ -1388,7 +2882,7 @@ namespace DiscordBot
                 if (MIT != Ret->GuildRef->Members->end())
                     Ret->Member = MIT->second;
                 else
-                    Ret->Member = GetMember(Ret->GuildRef, Ret->Author->ID);
+                    ResolveMember(Ret->GuildRef->ID, Ret->Author->ID, nullptr);
             }
         }
 
@@ -1424,6 +2918,34 @@ namespace DiscordBot
         return Ret;
     }
 
+    Message CDiscordClient::CreatePartialMessage(const std::string &GuildID, const std::string &ChannelID, const std::string &ID)
+    {
+        Message Ret = Message(new CMessage());
+        Channel channel;
+
+        Guilds::iterator IT = m_Guilds->find(GuildID);
+        if (IT != m_Guilds->end())
+        {
+            Ret->GuildRef = IT->second;
+            std::map<std::string, Channel>::iterator CIT = Ret->GuildRef->Channels->find(ChannelID);
+            if (CIT != Ret->GuildRef->Channels->end())
+                channel = CIT->second;
+        }
+
+        //Creates a dummy object for DMs.
+        if (!channel)
+        {
+            channel = Channel(new CChannel());
+            channel->ID = ChannelID;
+            channel->Type = ChannelTypes::DM;
+        }
+
+        Ret->ID = ID;
+        Ret->ChannelRef = channel;
+
+        return Ret;
+    }
+
     Activity CDiscordClient::CreateActivity(CJSON &json)
     {
         Activity ret = Activity(new CActivity());
@@ -33,6 +33,7 @@
 #include <ixwebsocket/IXNetSystem.h>
 #include <ixwebsocket/IXHttpClient.h>
 #include <thread>
+#include <condition_variable>
 #include <map>
 #include <models/User.hpp>
 #include <models/Guild.hpp>
@@ -45,6 +46,15 @@
 #include <models/atomic.hpp>
 #include "GuildAdmin.hpp"
 #include "../helpers/JSONHelpers.hpp"
+#include "GatewayShard.hpp"
+#include "ClusterClient.hpp"
+#include "IdentifyScheduler.hpp"
+#include "SessionCheckpoint.hpp"
+#include "WorkerPool.hpp"
+#include "WakeupEvent.hpp"
+#include "BotRuntime.hpp"
+#include "GatewayEvents.hpp"
+#include "TrafficRecorder.hpp"
 
 #undef SendMessage
 
@@ -52,6 +62,8 @@ namespace DiscordBot
 {
     class CDiscordClient : public IDiscordClient
     {
+        friend class CBotHost;
+
         public:
             //All informations from https://discordapp.com/developers/docs/topics/opcodes-and-status-codes
             enum class OPCodes
@@ -78,12 +90,17 @@ namespace DiscordBot
                 std::string Token;
                 std::map<std::string, std::string> Properties;
                 Intent Intents;
+                uint32_t ShardID;
+                uint32_t ShardCount;
+                uint32_t LargeThreshold;
 
                 void Serialize(CJSON &json) const
                 {
                     json.AddPair("token", Token);
                     json.AddPair("properties", Properties);
                     json.AddPair("intents", (uint32_t)Intents);
+                    json.AddPair("shard", std::vector<uint32_t>{ShardID, ShardCount});
+                    json.AddPair("large_threshold", LargeThreshold);
                 }
             };
 
@@ -113,12 +130,14 @@ namespace DiscordBot
                 uint32_t Total;
                 uint32_t Remaining;
                 uint32_t ResetAfter;
+                uint32_t MaxConcurrency;
 
                 void Deserialize(CJSON &json)
                 {
                     Total = json.GetValue<uint32_t>("total");
                     Remaining = json.GetValue<uint32_t>("remaining");
                     ResetAfter = json.GetValue<uint32_t>("reset_after");
+                    MaxConcurrency = json.GetValue<uint32_t>("max_concurrency");
                 }
             };
 
@@ -139,7 +158,10 @@ namespace DiscordBot
                 }
             };
 
-            CDiscordClient(const std::string &Token, Intent Intents);
+            /**
+             * @param Runtime: Shared resources of a bot host. Without a runtime the client creates its own. @see IBotHost
+             */
+            CDiscordClient(const std::string &Token, Intent Intents, BotRuntime Runtime = nullptr);
 
             /**
              * @brief Sets the online status of the bot.
@@ -163,6 +185,18 @@ namespace DiscordBot
              */
             void SetActivity(const std::string &Text, const std::string &URL = "") override;
 
+            /**
+             * @brief Starts a presence transaction. Changes of SetState, SetAFK and SetActivity are sent as one update after CommitPresenceUpdate(). @see CommitPresenceUpdate
+             * 
+             * @note Transactions can be nested.
+             */
+            void BeginPresenceUpdate() override;
+
+            /**
+             * @brief Finishes a presence transaction and sends the changes.
+             */
+            void CommitPresenceUpdate() override;
+
             /**
              * @brief Adds a song to the music queue.
              * 
@@ -268,11 +302,241 @@ namespace DiscordBot
              */
             bool IsPlaying(Guild guild) override;
 
+            /**
+             * @brief Enables the "zlib-stream" transport compression of the gateway connection. This reduces the bandwidth, especially for big guilds.
+             * 
+             * @param Compress: True to receive compressed gateway messages.
+             * 
+             * @note Must be called before Run().
+             */
+            void SetCompression(bool Compress) override
+            {
+                m_Compress = Compress;
+            }
+
+            /**
+             * @brief Sets the encoding of the gateway messages.
+             * 
+             * @param Encoding: Encoding which is used for the gateway connection. @see GatewayEncoding
+             * 
+             * @note Must be called before Run().
+             */
+            void SetEncoding(GatewayEncoding Encoding) override
+            {
+                m_Encoding = Encoding;
+            }
+
+            /**
+             * @brief Sets the count of gateway connections (shards). Each shard receives the events of a subset of guilds. Discord requires sharding for bots with more than 2500 guilds.
+             * 
+             * @param Count: Count of shards or 0 to use the count which is recommended by Discord.
+             * 
+             * @note Must be called before Run().
+             */
+            void SetShardCount(uint32_t Count) override
+            {
+                m_ShardCount = Count;
+            }
+
+            /**
+             * @brief Changes the count of shards while the bot is running. A second shard set with the new count connects in parallel and takes over the events, caches and voice connections after it received all its guilds.
+             * 
+             * @param Count: New count of shards.
+             * 
+             * @return Returns false if the bot isn't connected, runs inside a cluster or a resharding is already running.
+             */
+            bool Reshard(uint32_t Count) override;
+
+            /**
+             * @brief Runs this bot as part of a shard cluster. The shards of this process are assigned by the coordinator. @see IShardCoordinator
+             * 
+             * @param URL: Websocket url of the coordinator e.g. "ws://127.0.0.1:8540".
+             * 
+             * @note Must be called before Run(). Overrides SetShardCount.
+             */
+            void JoinCluster(const std::string &URL) override
+            {
+                m_ClusterURL = URL;
+            }
+
+            /**
+             * @return Gets the ids of all guilds of the cluster. Without a cluster only the ids of the local guilds are returned.
+             */
+            std::vector<std::string> GetClusterGuilds() override;
+
+            /**
+             * @brief Stores the sessions of all shards periodically and on Quit() in a file. On the next start the shards try to resume these sessions instead of identifying.
+             * 
+             * @param File: Path of the checkpoint file. An empty path disables the checkpoint.
+             * @param Interval: Interval in milliseconds to write the checkpoint.
+             * 
+             * @note Must be called before Run().
+             */
+            void SetSessionCheckpoint(const std::string &File, uint32_t Interval = 5000) override
+            {
+                m_CheckpointFile = File;
+                m_CheckpointInterval = Interval;
+            }
+
+            /**
+             * @brief Sets the count of threads which process the gateway events. Events of the same guild are processed in order, different guilds in parallel.
+             * 
+             * @param Count: Count of worker threads or 0 to process the events on the websocket thread. The default is 1, so the controller callbacks never run at the same time.
+             * 
+             * @note Must be called before Run(). With more than one worker the callbacks of different guilds run in parallel, so the controller must be thread safe.
+             */
+            void SetWorkerCount(uint32_t Count) override
+            {
+                m_WorkerCount = Count;
+            }
+
+            /**
+             * @brief Reconnects a shard which doesn't receive any event for the given time. Useful for bots which receive a steady stream of events.
+             * 
+             * @param Timeout: Time in milliseconds or 0 to disable. The default is 0.
+             * 
+             * @note A shard is always reconnected if a heartbeat isn't acknowledged in time.
+             */
+            void SetDispatchTimeout(uint32_t Timeout) override
+            {
+                m_DispatchTimeout = Timeout;
+            }
+
+            /**
+             * @brief Sets the member count at which a guild counts as large. Large guilds only send the online members on join.
+             * 
+             * @param Threshold: Value between 50 and 250. The default is 50.
+             * 
+             * @note Must be called before Run().
+             */
+            void SetLargeThreshold(uint32_t Threshold) override
+            {
+                m_LargeThreshold = std::min<uint32_t>(std::max<uint32_t>(Threshold, 50), 250);
+            }
+
+            /**
+             * @brief Enables the lazy loading of members for large guilds. The members of large guilds aren't loaded on join,
+             *        only the online members of the GUILD_CREATE event are stored. All other members are loaded on demand.
+             * 
+             * @note Use RequestGuildMembers() to load all members of a guild.
+             */
+            void SetLazyMembers(bool Lazy) override
+            {
+                m_LazyMembers = Lazy;
+            }
+
+            /**
+             * @brief Registers a handler which receives the undecoded data of a gateway event.
+             * 
+             * @param Event: Name of the event e.g. "MESSAGE_REACTION_ADD".
+             * @param Handler: Called with the shard id and the json "d" field of the event.
+             * 
+             * @note The handler is called on the worker of the guild, before the library processes the event.
+             */
+            void RegisterRawEventHandler(const std::string &Event, RawEventHandler Handler) override
+            {
+                std::lock_guard<std::mutex> lock(m_RawHandlersLock);
+                m_RawHandlers[Event].push_back(Handler);
+            }
+
+            /**
+             * @return Gets the state of all shards of this process.
+             */
+            std::vector<SShardStatus> GetShardStatus() override;
+
+            /**
+             * @brief Loads all members of a guild. The members are loaded in chunks. @see IController::OnGuildMembersChunk
+             * 
+             * @note Needs the GUILD_MEMBERS intent. Members of large guilds are loaded automatically, unless lazy member loading is enabled. @see SetLazyMembers
+             */
+            void RequestGuildMembers(Guild guild) override;
+
             /**
              * @brief Runs the bot. The call returns if you calls Quit(). @see Quit()
              */
             void Run() override;
 
+            /**
+             * @brief Connects the bot without blocking, for hosts with their own event loop.
+             * 
+             * The controller callbacks are queued and executed on the thread which calls Poll() or RunOnce().
+             * The sockets, timers and the voice playback still use internal threads.
+             * 
+             * @return Returns false if the gateway couldn't be requested.
+             * 
+             * @note Use this instead of Run(). The worker count is ignored. @see GetEventFD
+             */
+            bool Start() override;
+
+            /**
+             * @return Gets a fd which becomes readable if RunOnce() has work to do, e.g. to add it to an epoll set. Returns -1 on Windows.
+             */
+            int GetEventFD() override
+            {
+                return m_Wakeup.GetFD();
+            }
+
+            /**
+             * @brief Waits for queued events and executes them.
+             * 
+             * @param Timeout: Timeout in milliseconds. A negative timeout waits until an event is queued.
+             * 
+             * @return Returns false if the bot has quit.
+             */
+            bool Poll(int32_t Timeout) override;
+
+            /**
+             * @brief Executes all queued events without waiting.
+             * 
+             * @return Returns false if the bot has quit.
+             */
+            bool RunOnce() override;
+
+            /**
+             * @brief Records all received gateway frames to a file, which can be passed to Replay().
+             * 
+             * @note Must be called before Run().
+             */
+            void SetTrafficRecorder(const std::string &File) override
+            {
+                m_RecordFile = File;
+            }
+
+            /**
+             * @brief Sets the url of the REST api. Used to test the bot against a local server.
+             * 
+             * @param URL: Url without a trailing slash. The default is "https://discord.com/api".
+             * 
+             * @note Must be called before Run().
+             */
+            void SetBaseURL(const std::string &URL) override
+            {
+                m_BaseURL = URL;
+            }
+
+            /**
+             * @brief Overrides the gateway url which is returned by "/gateway/bot". Used to test the bot against a local server.
+             * 
+             * @param URL: Url without query parameters e.g. "ws://127.0.0.1:8080". An empty url uses the returned url.
+             * 
+             * @note Must be called before Run().
+             */
+            void SetGatewayURL(const std::string &URL) override
+            {
+                m_GatewayURL = URL;
+            }
+
+            /**
+             * @brief Feeds a file of the traffic recorder into this client, without a network connection. Use this instead of Run() to profile or benchmark the event processing.
+             * 
+             * @param File: File which was written by the traffic recorder. @see SetTrafficRecorder
+             * @param RealTime: True to replay with the recorded timing, false to replay as fast as possible.
+             * 
+             * @note Returns after all events are processed. The client sends nothing to the gateway, REST requests are still executed.
+             * @note The compression and the encoding of the recording are used, SetCompression() and SetEncoding() are ignored.
+             */
+            void Replay(const std::string &File, bool RealTime = false) override;
+
             /**
              * @brief Quits the bot. And disconnects all voice states.
              */
@@ -283,6 +547,22 @@ namespace DiscordBot
              */
             void QuitAsync() override;
 
+            /**
+             * @brief Quits the bot without ending the sessions, so a new process can take over without downtime.
+             * 
+             * The shards stop receiving events, all queued events are processed and the sessions, the guild caches, the voice channels and the music queues are written to the session checkpoint.
+             * The next process which uses the same checkpoint file resumes the sessions, restores the caches and joins the voice channels again. The interrupted songs are played again from the start.
+             * 
+             * @note Needs a session checkpoint file. @see SetSessionCheckpoint
+             * @note Must not be called from a controller callback, use HandoffAsync() instead. Inside a bot host the drain runs on its own thread, if it's started by a worker.
+             */
+            void Handoff() override;
+
+            /**
+             * @brief Same as Handoff() but as asynchronous call. @see Handoff()
+             */
+            void HandoffAsync() override;
+
             /**
              * @return Gets the bot user.
              */
@@ -352,7 +632,7 @@ namespace DiscordBot
                 return m_Users;
             }
 
-            ~CDiscordClient() {}
+            ~CDiscordClient();
 
 
             ix::HttpResponsePtr Get(const std::string &URL);
@@ -370,41 +650,97 @@ namespace DiscordBot
             enum
             {
                 QUEUE_NEXT_SONG,
+                CONNECT,
                 RESUME,
-                RECONNECT,
-                QUIT
+                HEARTBEAT_TIMEOUT,
+                SAVE_CHECKPOINT,
+                QUIT,
+                HANDOFF,
+                RESHARD,
+                RESHARD_TIMEOUT,
+                RELEASE_SHARDS
             };
 
-            const char *BASE_URL = "https://discord.com/api";
+            static const uint32_t GATEWAY_VERSION = 8;
+            static const int PRESENCE_WINDOW = 250;     //!< Presence changes within this time are merged into one update.
+            static const int CHECKPOINT_MAX_AGE = 120000;     //!< Older sessions aren't resumed.
+            static const int WATCHDOG_INTERVAL = 1000;
+            static const int MIN_ACK_TIMEOUT = 5000;        //!< Minimum time to wait for a heartbeat ack.
+            static const int ACK_TIMEOUT_FACTOR = 4;        //!< A heartbeat ack is overdue after this multiple of the p99 latency.
+            static const int RESHARD_MAX_WAIT = 600000;     //!< Time for a new shard set to receive its guilds.
+            static const int RELEASE_INTERVAL = 1000;       //!< Interval to check if retired shards can be deleted.
+
             std::string USER_AGENT;
 
             using VoiceSockets = std::map<std::string, VoiceSocket>;
             using AudioSources = std::map<std::string, AudioSource>;
             using MusicQueues = std::map<std::string, MusicQueue>;
+            using MemberCallback = std::function<void(Guild, GuildMember)>;
             using AdminInterfaces = std::map<std::string, GuildAdmin>;
 
+            BotRuntime m_Runtime;
+            TimerService m_Timer;
             CMessageManager m_EVManger;
             Intent m_Intents;
 
             std::string m_Token;
+            std::string m_BaseURL;
+            std::string m_GatewayURL;
             std::shared_ptr<SGateway> m_Gateway;
-            ix::WebSocket m_Socket;
-            ix::HttpClient m_HTTPClient;
+            std::shared_ptr<ix::HttpClient> m_HTTPClient;
+
+            bool m_Compress;
+            GatewayEncoding m_Encoding;
+
+            uint32_t m_ShardCount;      //!< Requested count of shards, 0 for the recommended count.
+            atomic<std::vector<GatewayShard>> m_Shards;
+            atomic<std::vector<GatewayShard>> m_StandbyShards;  //!< New shard set of a running resharding.
+            std::atomic<uint32_t> m_ShardGeneration;            //!< Generation of the newest shard set.
+            std::atomic<bool> m_Resharding;
+            atomic<std::vector<GatewayShard>> m_RetiredShards;  //!< Replaced shards are kept until their queued events are processed. @see ReleaseShards
+
+            std::string m_ClusterURL;
+            std::shared_ptr<CClusterClient> m_Cluster;
+            CIdentifyScheduler m_Identifier;
+
+            std::string m_CheckpointFile;
+            uint32_t m_CheckpointInterval;
+
+            uint32_t m_WorkerCount;
+            WorkerPool m_Workers;
+            std::thread m_HandoffThread;        //!< Drains the events of a handoff, which is started by a worker of a bot host.
+            std::mutex m_EventsLock;
+            std::condition_variable m_EventsDone;
+            uint32_t m_QueuedEvents;            //!< Queued events of this client on the pool of a bot host.
+            WorkerPool m_Lookups;               //!< Loads uncached members over http, so the events don't wait for them.
+            std::mutex m_LookupsLock;
+            std::map<std::string, std::vector<MemberCallback>> m_PendingLookups;  //!< Callbacks of the running lookups by "GuildID:UserID".
+            CWakeupEvent m_Wakeup;              //!< Signaled if events are queued for the host or the bot quits.
+            std::atomic<bool> m_External;       //!< True if the host executes the events. @see Start
+
+            std::atomic<uint32_t> m_DispatchTimeout;
+
+            uint32_t m_LargeThreshold;
+            std::atomic<bool> m_LazyMembers;
+
+            std::mutex m_RawHandlersLock;
+            std::map<std::string, std::vector<RawEventHandler>> m_RawHandlers;
+
+            std::string m_RecordFile;
+            CTrafficRecorder m_Recorder;
+            std::atomic<bool> m_Recording;
+            std::atomic<bool> m_Replay;
 
-            std::thread m_Heartbeat;
-            std::atomic<bool> m_Terminate;
-            std::atomic<bool> m_HeartACKReceived;
             std::atomic<bool> m_Quit;
-            uint32_t m_HeartbeatInterval;
-            std::atomic<uint32_t> m_LastSeqNum;
-            std::string m_SessionID;
-            User m_BotUser;
+            std::atomic<bool> m_Draining;       //!< True while a handoff stores the checkpoint.
 
-            // Unavailable guild IDs.
-            std::vector<std::string> m_Unavailables;
+            std::mutex m_VoiceSessionsLock;
+            std::vector<SVoiceSession> m_VoiceSessions;     //!< Voice channels of a handoff, which are joined again.
+            User m_BotUser;
 
-            //Map of all users in different servers.
-            atomic<Users> m_Users;
+            //Map of all users in different servers. Shared by all clients of a bot host.
+            std::shared_ptr<atomic<Users>> m_SharedUsers;
+            atomic<Users> &m_Users;
 
             //All Guilds where the bot is in.
             atomic<Guilds> m_Guilds;
@@ -418,10 +754,14 @@ namespace DiscordBot
 
             atomic<MusicQueues> m_MusicQueues;
 
+            std::mutex m_PresenceLock;
             bool m_IsAFK;
             OnlineState m_State;
             std::string m_Text; //Playing xy
             std::string m_URL;  //Streams on xy
+            uint32_t m_PresenceTransactions;    //!< Count of open presence transactions.
+            bool m_PresenceChanged;             //!< True if the presence changed inside a transaction.
+            TimerID m_PresenceTimer;
 
             /**
              * @return Creates a user info object and return it as json string.
@@ -433,11 +773,105 @@ namespace DiscordBot
              */
             void UpdateUserInfo();
 
+            /**
+             * @brief Schedules a presence update. Multiple calls within PRESENCE_WINDOW are merged. Must be called with locked m_PresenceLock.
+             */
+            void RequestPresenceUpdate();
+
             /**
              * @brief Joins or leaves a voice channel.
              */
             void ChangeVoiceState(const std::string &Guild, const std::string &Channel = "");
 
+            /**
+             * @return Returns the shard which receives the events of the given guild.
+             */
+            GatewayShard GetShard(const std::string &GuildID);
+
+            /**
+             * @return Returns the shard with the given id or null if the shard isn't running in this process.
+             */
+            GatewayShard FindShard(uint32_t ID);
+
+            /**
+             * @return Creates a new shard object.
+             */
+            GatewayShard CreateShard(uint32_t ID, uint32_t Count, uint32_t Generation = 0);
+
+            /**
+             * @brief Writes the sessions of all shards to the checkpoint file.
+             * 
+             * @param Caches: True to store the guild caches and voice channels too. Used for handoffs.
+             */
+            void SaveCheckpoint(bool Caches = false);
+
+            /**
+             * @brief Loads the sessions of the checkpoint file into the shards.
+             * 
+             * @return Returns true if at least one session can be resumed.
+             */
+            bool RestoreCheckpoint();
+
+            /**
+             * @brief Joins the voice channels of a handoff again, which belong to the shard.
+             */
+            void RejoinVoice(CGatewayShard *Shard);
+
+            /**
+             * @brief Handles the events of a standby shard. Only the guilds are tracked until the shard set takes over.
+             */
+            void OnStandbyDispatch(CGatewayShard *Shard, GatewayEvent Event, const std::string &Data, const SEnvelope &Env);
+
+            /**
+             * @brief Requests the switch to the standby shards if all of them received their guilds.
+             */
+            void CheckReshard();
+
+            /**
+             * @brief Replaces the current shards with the standby shards.
+             * 
+             * @param Generation: Shard set which should take over.
+             * @param Timeout: True to switch even if guilds are still unavailable. Aborts the resharding if not all standby shards are connected.
+             */
+            void SwitchShards(uint32_t Generation, bool Timeout);
+
+            /**
+             * @brief Stops the connections of replaced shards. Their sessions are kept until Discord drops them, so the voice states stay valid.
+             */
+            void RetireShards(const std::vector<GatewayShard> &Shards);
+
+            /**
+             * @brief Deletes the retired shards without queued events. Checks again later, if events are still queued.
+             */
+            void ReleaseShards();
+
+            /**
+             * @brief Sends the voice states of the bot again, so the voice connections belong to the sessions of the current shards.
+             */
+            void MoveVoice();
+
+            /**
+             * @brief Disconnects all shards and clears the caches.
+             * 
+             * @param Handoff: True to drain the queued events and store the sessions and caches for the next process. The voice channels aren't left.
+             */
+            void Shutdown(bool Handoff);
+
+            /**
+             * @return Returns the ids of all guilds of this process.
+             */
+            std::vector<std::string> GetLocalGuildIDs();
+
+            /**
+             * @brief Opens the connection of a shard.
+             */
+            void ConnectShard(GatewayShard Shard);
+
+            /**
+             * @return Returns the gateway url of a shard. Uses the resume url if the shard has a session.
+             */
+            std::string GetShardURL(CGatewayShard *Shard);
+
             /**
              * @brief Handles async. Messages.
              */
@@ -446,27 +880,94 @@ namespace DiscordBot
             /**
              * @brief Receives all websocket events from discord. This is the heart of the bot.
              */
-            void OnWebsocketEvent(const ix::WebSocketMessagePtr& msg);
+            void OnWebsocketEvent(CGatewayShard *Shard, const ix::WebSocketMessagePtr& msg);
+
+            /**
+             * @brief Processes a dispatch event. Runs on the worker of the guild.
+             */
+            void OnDispatch(CGatewayShard *Shard, GatewayEvent Event, const SPayload &Pay);
 
             /**
-             * @brief Sends a heartbeat.
+             * @return Returns the guild id of a dispatch event, which is used to order the events.
              */
-            void Heartbeat();
+            std::string GetEventKey(GatewayEvent Event, const SPayload &Pay);
+
+            /**
+             * @return Returns true if the event is used by the controller, the library or a raw handler.
+             */
+            bool IsSubscribed(GatewayEvent Event, const std::string &Name);
+
+            /**
+             * @return Returns true if the controller subscribes to the given event.
+             */
+            bool HasSubscription(EventSubscription Sub);
+
+            /**
+             * @brief Sends a heartbeat. Called by the timer service.
+             */
+            void Heartbeat(CGatewayShard *Shard);
+
+            /**
+             * @brief Detects dead connections before the next heartbeat. Called by the timer service.
+             */
+            void Watchdog(CGatewayShard *Shard);
+
+            /**
+             * @brief Stops the heartbeat and the watchdog of a shard.
+             */
+            void StopHeartbeat(CGatewayShard *Shard);
+
+            /**
+             * @brief Closes a shard connection which doesn't acknowledge the heartbeats and starts a resume.
+             */
+            void OnHeartbeatTimeout(GatewayShard Shard);
+
+            /**
+             * @brief Requests the gateway, creates the shards and starts the connections.
+             * 
+             * @param External: True if the events are executed by the host. @see Start
+             */
+            bool Connect(bool External);
+
+            /**
+             * @brief Queues a controller callback, which isn't called by a event, on the event workers.
+             * 
+             * @param Key: Guild of the callback. Session callbacks use the lane of the events without guild.
+             */
+            void NotifyController(std::function<void()> Callback, const std::string &Key = "");
+
+            /**
+             * @brief Queues an event on the worker of the key. Inside a bot host the events of this client are counted, so a handoff can drain them.
+             */
+            void PostEvent(const std::string &Key, CWorkerPool::Task Task);
+            void OnEventDone();
+
+            /**
+             * @brief Blocks until all counted events of this client are executed. @see PostEvent
+             */
+            void WaitForEvents();
+
+            /**
+             * @brief Reconnects a shard after a jittered backoff delay. Does nothing if a reconnect is already pending.
+             * 
+             * @param Resumable: False if the session is invalid and a new identify is needed.
+             */
+            void ScheduleReconnect(CGatewayShard *Shard, bool Resumable);
 
             /**
              * @brief Builds and sends a payload object.
              */
-            void SendOP(OPCodes OP, const std::string &D);
+            void SendOP(CGatewayShard *Shard, OPCodes OP, const std::string &D);
 
             /**
              * @brief Sends the identity.
              */
-            void SendIdentity();
+            void SendIdentity(CGatewayShard *Shard);
 
             /**
              * @brief Sends a resume request.
              */
-            void SendResume();
+            void SendResume(CGatewayShard *Shard);
 
             /**
              * @brief Called from voice socket if a audio source finished.
@@ -478,9 +979,27 @@ namespace DiscordBot
             std::string OnlineStateToStr(OnlineState state);
             OnlineState StrToOnlineState(const std::string &state);
 
+            /**
+             * @brief Creates a guild with all roles, channels, members and voice states of a GUILD_CREATE event.
+             */
+            Guild CreateGuild(CJSON &json);
+
             GuildMember CreateMember(CJSON &json, Guild guild);
+
+            /**
+             * @brief Loads a member which isn't cached in the background. The callback is called on the worker of the guild, after the member is added to the guild.
+             * 
+             * @note Lookups of the same member are merged into one request.
+             */
+            void ResolveMember(const std::string &GuildID, const std::string &UserID, MemberCallback Callback);
+
             VoiceState CreateVoiceState(CJSON &json, Guild guild);
             Message CreateMessage(CJSON &json);
+
+            /**
+             * @brief Creates a message which only contains the id, guild and channel.
+             */
+            Message CreatePartialMessage(const std::string &GuildID, const std::string &ChannelID, const std::string &ID);
             Activity CreateActivity(CJSON &json);
     };
 } // namespace DiscordBot
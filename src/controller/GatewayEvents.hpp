@@ -0,0 +1,168 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GATEWAYEVENTS_HPP
+#define GATEWAYEVENTS_HPP
+
+#include <string>
+#include <string.h>
+#include <algorithm>
+#include <iterator>
+
+namespace DiscordBot
+{
+    //Gateway Events https://discordapp.com/developers/docs/topics/gateway#commands-and-events-gateway-events
+    enum class GatewayEvent
+    {
+        UNKNOWN,
+        CHANNEL_CREATE,
+        CHANNEL_DELETE,
+        CHANNEL_PINS_UPDATE,
+        CHANNEL_UPDATE,
+        GUILD_BAN_ADD,
+        GUILD_BAN_REMOVE,
+        GUILD_CREATE,
+        GUILD_DELETE,
+        GUILD_EMOJIS_UPDATE,
+        GUILD_INTEGRATIONS_UPDATE,
+        GUILD_MEMBERS_CHUNK,
+        GUILD_MEMBER_ADD,
+        GUILD_MEMBER_REMOVE,
+        GUILD_MEMBER_UPDATE,
+        GUILD_ROLE_CREATE,
+        GUILD_ROLE_DELETE,
+        GUILD_ROLE_UPDATE,
+        GUILD_UPDATE,
+        INTERACTION_CREATE,
+        INVITE_CREATE,
+        INVITE_DELETE,
+        MESSAGE_CREATE,
+        MESSAGE_DELETE,
+        MESSAGE_DELETE_BULK,
+        MESSAGE_REACTION_ADD,
+        MESSAGE_REACTION_REMOVE,
+        MESSAGE_REACTION_REMOVE_ALL,
+        MESSAGE_REACTION_REMOVE_EMOJI,
+        MESSAGE_UPDATE,
+        PRESENCE_UPDATE,
+        READY,
+        RESUMED,
+        TYPING_START,
+        USER_UPDATE,
+        VOICE_SERVER_UPDATE,
+        VOICE_STATE_UPDATE,
+        WEBHOOKS_UPDATE
+    };
+
+    struct SGatewayEventName
+    {
+        const char *Name;
+        GatewayEvent Event;
+    };
+
+    /**
+     * @brief Lookup table of all event names. Must be sorted by name, this is checked at compile time.
+     */
+    static constexpr SGatewayEventName GATEWAY_EVENT_NAMES[] = {
+        {"CHANNEL_CREATE", GatewayEvent::CHANNEL_CREATE},
+        {"CHANNEL_DELETE", GatewayEvent::CHANNEL_DELETE},
+        {"CHANNEL_PINS_UPDATE", GatewayEvent::CHANNEL_PINS_UPDATE},
+        {"CHANNEL_UPDATE", GatewayEvent::CHANNEL_UPDATE},
+        {"GUILD_BAN_ADD", GatewayEvent::GUILD_BAN_ADD},
+        {"GUILD_BAN_REMOVE", GatewayEvent::GUILD_BAN_REMOVE},
+        {"GUILD_CREATE", GatewayEvent::GUILD_CREATE},
+        {"GUILD_DELETE", GatewayEvent::GUILD_DELETE},
+        {"GUILD_EMOJIS_UPDATE", GatewayEvent::GUILD_EMOJIS_UPDATE},
+        {"GUILD_INTEGRATIONS_UPDATE", GatewayEvent::GUILD_INTEGRATIONS_UPDATE},
+        {"GUILD_MEMBERS_CHUNK", GatewayEvent::GUILD_MEMBERS_CHUNK},
+        {"GUILD_MEMBER_ADD", GatewayEvent::GUILD_MEMBER_ADD},
+        {"GUILD_MEMBER_REMOVE", GatewayEvent::GUILD_MEMBER_REMOVE},
+        {"GUILD_MEMBER_UPDATE", GatewayEvent::GUILD_MEMBER_UPDATE},
+        {"GUILD_ROLE_CREATE", GatewayEvent::GUILD_ROLE_CREATE},
+        {"GUILD_ROLE_DELETE", GatewayEvent::GUILD_ROLE_DELETE},
+        {"GUILD_ROLE_UPDATE", GatewayEvent::GUILD_ROLE_UPDATE},
+        {"GUILD_UPDATE", GatewayEvent::GUILD_UPDATE},
+        {"INTERACTION_CREATE", GatewayEvent::INTERACTION_CREATE},
+        {"INVITE_CREATE", GatewayEvent::INVITE_CREATE},
+        {"INVITE_DELETE", GatewayEvent::INVITE_DELETE},
+        {"MESSAGE_CREATE", GatewayEvent::MESSAGE_CREATE},
+        {"MESSAGE_DELETE", GatewayEvent::MESSAGE_DELETE},
+        {"MESSAGE_DELETE_BULK", GatewayEvent::MESSAGE_DELETE_BULK},
+        {"MESSAGE_REACTION_ADD", GatewayEvent::MESSAGE_REACTION_ADD},
+        {"MESSAGE_REACTION_REMOVE", GatewayEvent::MESSAGE_REACTION_REMOVE},
+        {"MESSAGE_REACTION_REMOVE_ALL", GatewayEvent::MESSAGE_REACTION_REMOVE_ALL},
+        {"MESSAGE_REACTION_REMOVE_EMOJI", GatewayEvent::MESSAGE_REACTION_REMOVE_EMOJI},
+        {"MESSAGE_UPDATE", GatewayEvent::MESSAGE_UPDATE},
+        {"PRESENCE_UPDATE", GatewayEvent::PRESENCE_UPDATE},
+        {"READY", GatewayEvent::READY},
+        {"RESUMED", GatewayEvent::RESUMED},
+        {"TYPING_START", GatewayEvent::TYPING_START},
+        {"USER_UPDATE", GatewayEvent::USER_UPDATE},
+        {"VOICE_SERVER_UPDATE", GatewayEvent::VOICE_SERVER_UPDATE},
+        {"VOICE_STATE_UPDATE", GatewayEvent::VOICE_STATE_UPDATE},
+        {"WEBHOOKS_UPDATE", GatewayEvent::WEBHOOKS_UPDATE}
+    };
+
+    inline constexpr int CompareEventName(const char *A, const char *B)
+    {
+        while (*A && *A == *B)
+        {
+            A++;
+            B++;
+        }
+
+        return (unsigned char)*A - (unsigned char)*B;
+    }
+
+    inline constexpr bool IsEventTableSorted()
+    {
+        for (size_t i = 1; i < sizeof(GATEWAY_EVENT_NAMES) / sizeof(GATEWAY_EVENT_NAMES[0]); i++)
+        {
+            if(CompareEventName(GATEWAY_EVENT_NAMES[i - 1].Name, GATEWAY_EVENT_NAMES[i].Name) >= 0)
+                return false;
+        }
+
+        return true;
+    }
+
+    static_assert(IsEventTableSorted(), "GATEWAY_EVENT_NAMES must be sorted by name and free of duplicates.");
+
+    /**
+     * @return Gets the event of a dispatch event name or GatewayEvent::UNKNOWN.
+     */
+    inline GatewayEvent GetGatewayEvent(const std::string &Name)
+    {
+        auto IT = std::lower_bound(std::begin(GATEWAY_EVENT_NAMES), std::end(GATEWAY_EVENT_NAMES), Name.c_str(), [](const SGatewayEventName &Entry, const char *Val)
+        {
+            return CompareEventName(Entry.Name, Val) < 0;
+        });
+
+        if(IT != std::end(GATEWAY_EVENT_NAMES) && CompareEventName(IT->Name, Name.c_str()) == 0)
+            return IT->Event;
+
+        return GatewayEvent::UNKNOWN;
+    }
+} // namespace DiscordBot
+
+#endif //GATEWAYEVENTS_HPP
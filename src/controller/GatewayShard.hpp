@@ -0,0 +1,148 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GATEWAYSHARD_HPP
+#define GATEWAYSHARD_HPP
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <memory>
+#include <stdint.h>
+#include <ixwebsocket/IXWebSocket.h>
+#include <models/atomic.hpp>
+#include "TimerService.hpp"
+#include "OutboundQueue.hpp"
+#include "MemberChunkLoader.hpp"
+#include "LatencyTracker.hpp"
+#include "ReconnectBackoff.hpp"
+#include "../helpers/ZLibStream.hpp"
+#include "../helpers/ETF.hpp"
+
+namespace DiscordBot
+{
+    /**
+     * @brief State of one gateway connection. Each shard has its own socket, heartbeat, session and sequence number.
+     */
+    class CGatewayShard : public std::enable_shared_from_this<CGatewayShard>
+    {
+        public:
+            static const uint32_t NO_SEQUENCE = UINT32_MAX;     //!< Sequence number before the first dispatch.
+
+            /**
+             * @param ID: Shard id.
+             * @param Count: Total count of shards.
+             * @param Timer: Timer of the outbound rate limiter and the member loader.
+             * @param Generation: Shard set of this shard.
+             */
+            CGatewayShard(uint32_t ID, uint32_t Count, TimerService Timer, uint32_t Generation = 0) : ID(ID), Count(Count), Generation(Generation), Outbound(Timer, [this](const std::string &Data, bool Binary){ Socket.send(Data, Binary); }), MemberLoader(Timer), HeartbeatTimer(CTimerService::INVALID_TIMER), WatchdogTimer(CTimerService::INVALID_TIMER), HeartbeatSent(0), LastDispatch(0), ReconnectPending(false), Standby(false), Retired(false), QueuedEvents(0), Terminate(false), HeartACKReceived(false), HeartbeatInterval(0), LastSeqNum(NO_SEQUENCE), Ready(false) {}
+
+            const uint32_t ID;              //!< Shard id.
+            const uint32_t Count;           //!< Total count of shards.
+            const uint32_t Generation;      //!< Shard set of this shard, increased by each resharding.
+
+            ix::WebSocket Socket;
+            COutboundQueue Outbound;        //!< All commands are sent through this queue.
+            CMemberChunkLoader MemberLoader;
+            std::atomic<TimerID> HeartbeatTimer;
+            std::atomic<TimerID> WatchdogTimer;     //!< Checks the connection for missing acks and events.
+            std::atomic<int64_t> HeartbeatSent;     //!< Steady time of the last heartbeat.
+            std::atomic<int64_t> LastDispatch;      //!< Steady time of the last received event.
+            CLatencyTracker Latency;                //!< Round trip times of the heartbeats.
+            CReconnectBackoff Backoff;              //!< Delays of the reconnects.
+            std::atomic<bool> ReconnectPending;     //!< True if a reconnect is already scheduled.
+            std::atomic<bool> Standby;              //!< True if the shard belongs to a new shard set which doesn't dispatch events yet.
+            std::atomic<bool> Retired;              //!< True if the shard was replaced by a new shard set. All its events are ignored.
+            std::atomic<uint32_t> QueuedEvents;     //!< Events of this shard which wait for a worker.
+            std::atomic<bool> Terminate;
+            std::atomic<bool> HeartACKReceived;
+            uint32_t HeartbeatInterval;
+            std::atomic<uint32_t> LastSeqNum;       //!< NO_SEQUENCE until the first dispatch.
+            atomic<std::string> SessionID;
+            atomic<std::string> ResumeURL;  //!< Gateway url for resuming the session.
+            std::atomic<bool> Ready;        //!< True if the shard received the READY event.
+
+            CZLibStream Inflater;           //!< One inflate context per connection.
+            CETFDecoder ETFDecoder;
+            std::string ETFBuffer;          //!< Reusable buffer for decoded etf messages.
+
+            /**
+             * @brief Marks a guild as unavailable.
+             */
+            void AddUnavailable(const std::string &GuildID)
+            {
+                std::lock_guard<std::mutex> lock(m_UnavailablesLock);
+                m_Unavailables.push_back(GuildID);
+            }
+
+            /**
+             * @return Returns true if the guild was unavailable.
+             */
+            bool RemoveUnavailable(const std::string &GuildID)
+            {
+                std::lock_guard<std::mutex> lock(m_UnavailablesLock);
+                auto IT = std::find(m_Unavailables.begin(), m_Unavailables.end(), GuildID);
+                if(IT == m_Unavailables.end())
+                    return false;
+
+                m_Unavailables.erase(IT);
+                return true;
+            }
+
+            /**
+             * @return Returns true if guilds of this shard are still unavailable.
+             */
+            bool HasUnavailables()
+            {
+                std::lock_guard<std::mutex> lock(m_UnavailablesLock);
+                return !m_Unavailables.empty();
+            }
+
+            /**
+             * @return Returns the shard id which receives the events of the given guild.
+             */
+            static inline uint32_t GetShardID(const std::string &GuildID, uint32_t Count)
+            {
+                if(GuildID.empty() || Count <= 1)
+                    return 0;
+
+                return (uint32_t)((std::stoull(GuildID) >> 22) % Count);
+            }
+
+            ~CGatewayShard() {}
+
+        private:
+            //Unavailable guild IDs of this shard. The guild events are processed by different workers.
+            std::mutex m_UnavailablesLock;
+            std::vector<std::string> m_Unavailables;
+    };
+
+    using GatewayShard = std::shared_ptr<CGatewayShard>;
+} // namespace DiscordBot
+
+
+#endif //GATEWAYSHARD_HPP
@@ -280,6 +280,26 @@ namespace DiscordBot
         }
     }
 
+    void CGuildAdmin::OnMessagesDeleted(Channel c, const std::vector<std::string> &IDs)
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        std::vector<std::string> ChannelIDs = {
+            "",
+            c->ID
+        };
+
+        for (auto ID : ChannelIDs)
+        {
+            auto IT = m_Actions.find(ID);
+            if(IT != m_Actions.end())
+            {
+                auto InnerIT = IT->second.find(ActionType::MESSAGES_DELETED);
+                if(InnerIT != IT->second.end())
+                    FireAction(ActionType::MESSAGES_DELETED, InnerIT->second, c, IDs);
+            }
+        }
+    }
+
     //--------------------------Private--------------------------//
 
     GuildMember CGuildAdmin::CheckBotPermissions(Permission p, const std::string &errMsg)
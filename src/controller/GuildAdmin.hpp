@@ -54,6 +54,7 @@ namespace DiscordBot
             // Internal events for the actions.
             void OnUserVoiceStateChanged(Channel c, GuildMember m);
             void OnMessageEvent(ActionType Type, Channel c, Message m);
+            void OnMessagesDeleted(Channel c, const std::vector<std::string> &IDs);
 
             ~CGuildAdmin() {}
 
@@ -119,7 +119,7 @@ namespace DiscordBot
         if(!guild)
             return m_CommandDescs[Cmd].Mode == AccessMode::EVERYBODY;
 
-        if (guild->Owner->UserRef->ID == member->UserRef->ID)
+        if (guild->OwnerID == member->UserRef->ID)
             return true;        
 
         std::vector<std::string> RoleIDs = CmdsConfig->GetRoles(guild->ID, Cmd);
@@ -133,6 +133,19 @@ namespace DiscordBot
         return m_QueueIndex < m_Queue.size();
     }
 
+    /**
+     * @return Returns the current song and all songs after it.
+     */
+    std::vector<SongInfo> IMusicQueue::GetPendingSongs()
+    {
+        std::lock_guard<std::mutex> lock(m_QueueLock);
+        size_t Start = m_QueueIndex > 0 ? m_QueueIndex - 1 : 0;
+        if(Start >= m_Queue.size())
+            return std::vector<SongInfo>();
+
+        return std::vector<SongInfo>(m_Queue.begin() + Start, m_Queue.end());
+    }
+
     /**
      * @return Gets the song at a given index. Returns null if the index is out of bounds.
      */
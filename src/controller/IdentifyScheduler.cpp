@@ -0,0 +1,167 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "IdentifyScheduler.hpp"
+#include "../helpers/Helper.hpp"
+#include <Log.hpp>
+#include <algorithm>
+
+namespace DiscordBot
+{
+    const int CIdentifyScheduler::IDENTIFY_DELAY;
+    const uint32_t CIdentifyScheduler::LOW_REMAINING;
+    const int64_t CIdentifyScheduler::RESET_PERIOD;
+
+    CIdentifyScheduler::CIdentifyScheduler() : m_Terminate(false), m_LastIdentify(1, -IDENTIFY_DELAY), m_NextAllowed(0), m_Total(1000), m_Remaining(1000), m_ResetAt(0)
+    {
+        m_Thread = std::thread(&CIdentifyScheduler::Executor, this);
+    }
+
+    void CIdentifyScheduler::SetLimit(uint32_t Total, uint32_t Remaining, uint32_t ResetAfter, uint32_t MaxConcurrency)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            m_Total = Total;
+            m_Remaining = Remaining;
+            m_ResetAt = GetSteadyMillis() + ResetAfter;
+            m_LastIdentify.assign(std::max<uint32_t>(MaxConcurrency, 1), -IDENTIFY_DELAY);
+
+            //Nothing may be identified until the reset.
+            if(m_Remaining == 0)
+                m_NextAllowed = m_ResetAt;
+
+            if(m_Remaining <= LOW_REMAINING)
+                llog << linfo << "Only " << m_Remaining << " of " << m_Total << " session starts remaining. Reset in " << ResetAfter / 1000 << "s" << lendl;
+        }
+
+        m_Signal.notify_all();
+    }
+
+    void CIdentifyScheduler::Request(uint32_t ShardID, IdentifyCallback Callback, uint32_t Generation)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            auto IT = std::find_if(m_Queue.begin(), m_Queue.end(), [ShardID, Generation](const SRequest &r){ return r.ShardID == ShardID && r.Generation == Generation; });
+            if(IT != m_Queue.end())
+                IT->Callback = Callback;
+            else
+                m_Queue.push_back({ShardID, Generation, Callback});
+        }
+
+        m_Signal.notify_all();
+    }
+
+    void CIdentifyScheduler::Cancel(uint32_t ShardID, uint32_t Generation)
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        m_Queue.remove_if([ShardID, Generation](const SRequest &r){ return r.ShardID == ShardID && r.Generation == Generation; });
+    }
+
+    void CIdentifyScheduler::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            m_Terminate = true;
+            m_Queue.clear();
+        }
+
+        m_Signal.notify_all();
+        if(m_Thread.joinable() && m_Thread.get_id() != std::this_thread::get_id())
+            m_Thread.join();
+    }
+
+    void CIdentifyScheduler::Executor()
+    {
+        std::unique_lock<std::mutex> lock(m_Lock);
+        while (!m_Terminate)
+        {
+            int64_t Now = GetSteadyMillis();
+            int64_t WakeUp = Now + 1000;
+
+            //The reset period is over.
+            if(m_ResetAt != 0 && Now >= m_ResetAt)
+            {
+                m_Remaining = m_Total;
+                m_ResetAt = Now + RESET_PERIOD;
+            }
+
+            IdentifyCallback Callback;
+            if(Now >= m_NextAllowed)
+            {
+                //Grants the first request whose bucket is free.
+                for (auto IT = m_Queue.begin(); IT != m_Queue.end(); IT++)
+                {
+                    int64_t &Last = m_LastIdentify[IT->ShardID % m_LastIdentify.size()];
+                    if(Now - Last >= IDENTIFY_DELAY)
+                    {
+                        Last = Now;
+                        Callback = IT->Callback;
+                        m_Queue.erase(IT);
+
+                        if(m_Remaining > 0)
+                            m_Remaining--;
+
+                        m_NextAllowed = CalculateBackoff(Now);
+                        break;
+                    }
+
+                    WakeUp = std::min(WakeUp, Last + IDENTIFY_DELAY);
+                }
+            }
+            else
+                WakeUp = m_NextAllowed;
+
+            if(Callback)
+            {
+                lock.unlock();
+                Callback();
+                lock.lock();
+                continue;
+            }
+
+            m_Signal.wait_for(lock, std::chrono::milliseconds(std::max<int64_t>(WakeUp - Now, 1)));
+        }
+    }
+
+    int64_t CIdentifyScheduler::CalculateBackoff(int64_t Now)
+    {
+        if(m_Remaining > LOW_REMAINING)
+            return 0;
+
+        //No session starts left, waits until the limit resets.
+        if(m_Remaining == 0)
+        {
+            llog << lerror << "Session start limit reached. The next identify is delayed for " << (m_ResetAt - Now) / 1000 << "s" << lendl;
+            return m_ResetAt;
+        }
+
+        //Spreads the remaining session starts over the reset period.
+        return Now + std::max<int64_t>((m_ResetAt - Now) / m_Remaining, IDENTIFY_DELAY);
+    }
+
+    CIdentifyScheduler::~CIdentifyScheduler()
+    {
+        Stop();
+    }
+} // namespace DiscordBot
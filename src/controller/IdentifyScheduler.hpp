@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IDENTIFYSCHEDULER_HPP
+#define IDENTIFYSCHEDULER_HPP
+
+#include <functional>
+#include <list>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <stdint.h>
+
+namespace DiscordBot
+{
+    /**
+     * @brief Queues the identifies of all shards and grants them in the order Discord allows.
+     * 
+     * Each shard belongs to the concurrency bucket "ShardID % MaxConcurrency". Only one identify per bucket is allowed in IDENTIFY_DELAY milliseconds.
+     * If the remaining session starts are running low, the identifies are spread over the time until the limit resets.
+     */
+    class CIdentifyScheduler
+    {
+        public:
+            using IdentifyCallback = std::function<void()>;
+
+            CIdentifyScheduler();
+
+            /**
+             * @brief Sets the session start limit which is returned by "/gateway/bot".
+             * 
+             * @param Total: Total session starts per reset period.
+             * @param Remaining: Remaining session starts.
+             * @param ResetAfter: Milliseconds until the remaining session starts are reset.
+             * @param MaxConcurrency: Count of identifies which are allowed at the same time.
+             */
+            void SetLimit(uint32_t Total, uint32_t Remaining, uint32_t ResetAfter, uint32_t MaxConcurrency);
+
+            /**
+             * @brief Queues an identify. The callback is called from the scheduler thread if the identify is allowed.
+             * 
+             * @param ShardID: Id of the shard.
+             * @param Callback: Sends the identify.
+             * @param Generation: Shard set of the shard. Shards of different sets may have the same id during a resharding.
+             * 
+             * @note A pending request of the same shard is replaced.
+             */
+            void Request(uint32_t ShardID, IdentifyCallback Callback, uint32_t Generation = 0);
+
+            /**
+             * @brief Removes a pending request, e.g. the connection of the shard is closed.
+             */
+            void Cancel(uint32_t ShardID, uint32_t Generation = 0);
+
+            /**
+             * @brief Stops the scheduler thread. Pending requests are dropped.
+             */
+            void Stop();
+
+            ~CIdentifyScheduler();
+
+        private:
+            static const int IDENTIFY_DELAY = 5000;     //!< Delay between two identifies of the same bucket.
+            static const uint32_t LOW_REMAINING = 10;   //!< Below this count of remaining session starts, the identifies are spread over the reset period.
+            static const int64_t RESET_PERIOD = 86400000;   //!< Discord resets the session starts every 24 hours.
+
+            struct SRequest
+            {
+                uint32_t ShardID;
+                uint32_t Generation;
+                IdentifyCallback Callback;
+            };
+
+            std::mutex m_Lock;
+            std::condition_variable m_Signal;
+            std::atomic<bool> m_Terminate;
+
+            std::list<SRequest> m_Queue;
+            std::vector<int64_t> m_LastIdentify;        //!< Last identify per concurrency bucket.
+            int64_t m_NextAllowed;                      //!< Global earliest time of the next identify, used for the back-off. All times are steady clock milliseconds.
+
+            uint32_t m_Total;
+            uint32_t m_Remaining;
+            int64_t m_ResetAt;
+
+            std::thread m_Thread;
+
+            void Executor();
+
+            /**
+             * @return Returns the time of the next identify after one identify was granted.
+             */
+            int64_t CalculateBackoff(int64_t Now);
+    };
+} // namespace DiscordBot
+
+
+#endif //IDENTIFYSCHEDULER_HPP
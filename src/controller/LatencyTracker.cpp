@@ -0,0 +1,81 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "LatencyTracker.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace DiscordBot
+{
+    const size_t CLatencyTracker::SAMPLES;
+    const double CLatencyTracker::SMOOTHING = 0.125;
+
+    void CLatencyTracker::Add(uint32_t RTT)
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        m_Last = RTT;
+
+        if(m_Samples.empty())
+            m_Average = RTT;
+        else
+            m_Average += SMOOTHING * ((double)RTT - m_Average);
+
+        //Ring buffer of the last samples.
+        if(m_Samples.size() < SAMPLES)
+            m_Samples.push_back(RTT);
+        else
+            m_Samples[m_Next] = RTT;
+
+        m_Next = (m_Next + 1) % SAMPLES;
+    }
+
+    uint32_t CLatencyTracker::GetLast()
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        return m_Last;
+    }
+
+    uint32_t CLatencyTracker::GetAverage()
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        return (uint32_t)std::lround(m_Average);
+    }
+
+    uint32_t CLatencyTracker::GetP99()
+    {
+        std::vector<uint32_t> Samples;
+        {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            Samples = m_Samples;
+        }
+
+        if(Samples.empty())
+            return 0;
+
+        size_t Index = (size_t)std::ceil(Samples.size() * 0.99) - 1;
+        std::nth_element(Samples.begin(), Samples.begin() + Index, Samples.end());
+
+        return Samples[Index];
+    }
+} // namespace DiscordBot
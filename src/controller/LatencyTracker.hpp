@@ -0,0 +1,75 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LATENCYTRACKER_HPP
+#define LATENCYTRACKER_HPP
+
+#include <vector>
+#include <mutex>
+#include <stdint.h>
+
+namespace DiscordBot
+{
+    /**
+     * @brief Collects round trip times and calculates the last, the smoothed and the 99th percentile latency.
+     */
+    class CLatencyTracker
+    {
+        public:
+            CLatencyTracker() : m_Last(0), m_Average(0), m_Next(0) {}
+
+            /**
+             * @brief Adds a measured round trip time in milliseconds.
+             */
+            void Add(uint32_t RTT);
+
+            /**
+             * @return Gets the last round trip time.
+             */
+            uint32_t GetLast();
+
+            /**
+             * @return Gets the exponentially weighted moving average of the round trip times.
+             */
+            uint32_t GetAverage();
+
+            /**
+             * @return Gets the 99th percentile of the last samples. 0 if there are no samples.
+             */
+            uint32_t GetP99();
+
+        private:
+            static const size_t SAMPLES = 128;    //!< Count of samples for the percentile.
+            static const double SMOOTHING;
+
+            std::mutex m_Lock;
+            uint32_t m_Last;
+            double m_Average;
+            std::vector<uint32_t> m_Samples;
+            size_t m_Next;
+    };
+} // namespace DiscordBot
+
+
+#endif //LATENCYTRACKER_HPP
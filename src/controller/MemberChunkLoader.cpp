@@ -0,0 +1,147 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "MemberChunkLoader.hpp"
+#include <Log.hpp>
+#include <algorithm>
+
+namespace DiscordBot
+{
+    const size_t CMemberChunkLoader::MAX_OUTSTANDING;
+    const uint32_t CMemberChunkLoader::REQUEST_TIMEOUT;
+
+    void CMemberChunkLoader::Request(const std::string &GuildID)
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+
+        //Already requested.
+        if(m_Outstanding.find(GuildID) != m_Outstanding.end() || std::find(m_Pending.begin(), m_Pending.end(), GuildID) != m_Pending.end())
+            return;
+
+        m_Pending.push_back(GuildID);
+        Pump();
+    }
+
+    bool CMemberChunkLoader::OnChunk(const std::string &GuildID, uint32_t Index, uint32_t Count)
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        if(Index + 1 < Count)
+            return false;
+
+        m_Outstanding.erase(GuildID);
+        Pump();
+
+        return true;
+    }
+
+    void CMemberChunkLoader::Start()
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        m_Active = true;
+        Pump();
+    }
+
+    void CMemberChunkLoader::Reset()
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        m_Active = false;
+
+        //Discord doesn't answer requests of an old connection.
+        for (auto &&e : m_Outstanding)
+            m_Pending.push_front(e.first);
+
+        m_Outstanding.clear();
+    }
+
+    void CMemberChunkLoader::Pump()
+    {
+        while (m_Active && !m_Pending.empty() && m_Outstanding.size() < MAX_OUTSTANDING)
+        {
+            std::string GuildID = m_Pending.front();
+            m_Pending.pop_front();
+
+            m_Outstanding[GuildID] = Clock::now();
+            m_Request(GuildID);
+        }
+
+        ScheduleExpire();
+    }
+
+    void CMemberChunkLoader::Remove(const std::string &GuildID)
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        m_Pending.erase(std::remove(m_Pending.begin(), m_Pending.end(), GuildID), m_Pending.end());
+
+        if(m_Outstanding.erase(GuildID) != 0)
+            Pump();
+    }
+
+    void CMemberChunkLoader::ScheduleExpire()
+    {
+        if(m_Outstanding.empty() || m_ExpireTimer != CTimerService::INVALID_TIMER)
+            return;
+
+        Clock::time_point Oldest = Clock::now();
+        for (auto &&e : m_Outstanding)
+            Oldest = std::min(Oldest, e.second);
+
+        Clock::time_point Expire = Oldest + std::chrono::milliseconds(REQUEST_TIMEOUT);
+        uint32_t Delay = (uint32_t)std::max<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(Expire - Clock::now()).count(), 1);
+        m_ExpireTimer = m_Timer->Schedule(Delay, std::bind(&CMemberChunkLoader::OnExpire, this));
+    }
+
+    void CMemberChunkLoader::OnExpire()
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        m_ExpireTimer = CTimerService::INVALID_TIMER;
+
+        Clock::time_point Now = Clock::now();
+        auto IT = m_Outstanding.begin();
+        while (IT != m_Outstanding.end())
+        {
+            if(Now - IT->second >= std::chrono::milliseconds(REQUEST_TIMEOUT))
+            {
+                llog << lerror << "Member request of guild " << IT->first << " timed out" << lendl;
+                IT = m_Outstanding.erase(IT);
+            }
+            else
+                IT++;
+        }
+
+        Pump();
+    }
+
+    CMemberChunkLoader::~CMemberChunkLoader()
+    {
+        TimerID ID;
+
+        {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            ID = m_ExpireTimer;
+            m_Active = false;
+        }
+
+        m_Timer->Cancel(ID);
+    }
+} // namespace DiscordBot
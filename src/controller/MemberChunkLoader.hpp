@@ -0,0 +1,123 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MEMBERCHUNKLOADER_HPP
+#define MEMBERCHUNKLOADER_HPP
+
+#include <functional>
+#include <deque>
+#include <map>
+#include <string>
+#include <mutex>
+#include <chrono>
+#include <stdint.h>
+#include "TimerService.hpp"
+
+namespace DiscordBot
+{
+    /**
+     * @brief Loads the members of large guilds via REQUEST_GUILD_MEMBERS. Discord answers each request with a stream of GUILD_MEMBERS_CHUNK events.
+     * 
+     * The loader limits the requests which are outstanding on one shard, the other guilds are queued.
+     * Requests which discord doesn't answer expire, so they don't block the other guilds.
+     */
+    class CMemberChunkLoader
+    {
+        public:
+            using RequestFunc = std::function<void(const std::string &GuildID)>;
+
+            static const size_t MAX_OUTSTANDING = 2;    //!< Guilds which are loaded at the same time per shard.
+            static const uint32_t REQUEST_TIMEOUT = 30000;  //!< Time in milliseconds until a request without answer is dropped.
+
+            /**
+             * @param Timer: Timer which expires the unanswered requests.
+             */
+            CMemberChunkLoader(TimerService Timer) : m_Timer(Timer), m_Active(false), m_ExpireTimer(CTimerService::INVALID_TIMER) {}
+
+            /**
+             * @brief Sets the function which sends the REQUEST_GUILD_MEMBERS command for a guild.
+             */
+            void SetRequestFunc(RequestFunc Request)
+            {
+                std::lock_guard<std::mutex> lock(m_Lock);
+                m_Request = Request;
+            }
+
+            /**
+             * @brief Queues the member request of a guild.
+             */
+            void Request(const std::string &GuildID);
+
+            /**
+             * @brief Processes the chunk information of a GUILD_MEMBERS_CHUNK event.
+             * 
+             * @return Returns true if this was the last chunk of the guild.
+             */
+            bool OnChunk(const std::string &GuildID, uint32_t Index, uint32_t Count);
+
+            /**
+             * @brief Starts sending requests. Called if the session is ready.
+             */
+            void Start();
+
+            /**
+             * @brief Called if the connection is lost. Unfinished requests are sent again after the next Start().
+             */
+            void Reset();
+
+            /**
+             * @brief Drops the requests of a guild. Called if the guild is deleted.
+             */
+            void Remove(const std::string &GuildID);
+
+            ~CMemberChunkLoader();
+
+        private:
+            using Clock = std::chrono::steady_clock;
+
+            TimerService m_Timer;
+            RequestFunc m_Request;
+
+            std::mutex m_Lock;
+            bool m_Active;
+            std::deque<std::string> m_Pending;
+            std::map<std::string, Clock::time_point> m_Outstanding;     //!< Send time of each outstanding request.
+            TimerID m_ExpireTimer;
+
+            /**
+             * @brief Sends the next requests. Must be called with locked m_Lock.
+             */
+            void Pump();
+
+            /**
+             * @brief Schedules the expiration of the oldest outstanding request. Must be called with locked m_Lock.
+             */
+            void ScheduleExpire();
+
+            void OnExpire();
+    };
+} // namespace DiscordBot
+
+
+#endif //MEMBERCHUNKLOADER_HPP
@@ -28,11 +28,17 @@
 #include <queue>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <map>
+#include <set>
 #include <functional>
 #include <atomic>
 #include <memory>
+#include <string>
+#include <stdint.h>
 #include "../helpers/Helper.hpp"
+#include "TimerService.hpp"
+#include "WorkerPool.hpp"
 
 namespace DiscordBot
 {
@@ -68,7 +74,20 @@ namespace DiscordBot
         public:
             using OnMessageReceive = std::function<void(const MessageBase Msg)>;
 
-            CMessageManager(/* args */) : m_Terminated(false), m_Thread(&CMessageManager::Executor, this) {}
+            /**
+             * @param Timer: Timer which delays the posted messages.
+             * @param Executor: Shared pool which delivers the messages. Without a pool the manager uses its own thread.
+             */
+            CMessageManager(TimerService Timer, WorkerPool Executor = nullptr) : m_Timer(Timer), m_Terminated(false), m_Executor(Executor), m_Scheduled(false)
+            {
+                if(m_Executor)
+                {
+                    m_State = std::make_shared<SExecutorState>();
+                    m_Key = std::to_string((uintptr_t)this);
+                }
+                else
+                    m_Thread = std::thread(&CMessageManager::Executor, this);
+            }
 
             /**
              * @brief Subscribes a message type.
@@ -92,11 +111,15 @@ namespace DiscordBot
                 SendMessage(Msg);
             }
 
+            /**
+             * @brief Queues a message for the executor thread.
+             * 
+             * @param Timeout: Delay in milliseconds before the message is delivered. Delayed messages are scheduled on the timer.
+             */
             template<class T>
             void PostMessage(size_t Event, T Value, int Timeout = 0)
             {
                 using Message = std::shared_ptr<TMessage<T>>;
-                std::lock_guard<std::mutex> lock(m_QueueLock);
 
                 Message Msg = Message(new TMessage<T>());
                 Msg->Value = Value;
@@ -104,36 +127,145 @@ namespace DiscordBot
                 Msg->Timeout = Timeout;
                 Msg->CreateddMs = GetTimeMillis();
 
-                m_Queue.push(std::static_pointer_cast<IMessageBase>(Msg));
+                std::lock_guard<std::mutex> lock(m_QueueLock);
+                if(Timeout <= 0)
+                {
+                    Enqueue(Msg);
+                    return;
+                }
+
+                //The timer callback waits for the lock, so the id is stored before the callback can remove it.
+                auto ID = std::make_shared<TimerID>();
+                *ID = m_Timer->Schedule(Timeout, [this, Msg, ID]()
+                {
+                    std::lock_guard<std::mutex> lock(m_QueueLock);
+                    m_Timers.erase(*ID);
+
+                    if(!m_Terminated)
+                        Enqueue(Msg);
+                });
+
+                m_Timers.insert(*ID);
             }
 
             ~CMessageManager() 
             {
-                m_Terminated = true;
+                std::set<TimerID> Timers;
+
+                {
+                    std::lock_guard<std::mutex> lock(m_QueueLock);
+                    m_Terminated = true;
+                    Timers.swap(m_Timers);
+                    m_Signal.notify_all();
+                }
+
+                for (auto &&e : Timers)
+                    m_Timer->Cancel(e);
+
                 if(m_Thread.joinable())
                     m_Thread.join();
+
+                //Waits for a running delivery. Queued deliveries see the flag and don't touch this object.
+                if(m_State)
+                {
+                    std::unique_lock<std::mutex> lock(m_State->Lock);
+                    m_State->Terminated = true;
+                    m_State->Idle.wait(lock, [this]()
+                    {
+                        return !m_State->Running || m_State->Thread == std::this_thread::get_id();
+                    });
+                }
             }
 
         private:
+            /**
+             * @brief Lifetime of a manager which uses a shared pool. The deliveries keep the state alive.
+             */
+            struct SExecutorState
+            {
+                SExecutorState() : Running(false), Terminated(false) {}
+
+                std::mutex Lock;
+                std::condition_variable Idle;
+                bool Running;
+                bool Terminated;
+                std::thread::id Thread;
+            };
+
+            /**
+             * @brief Queues a message and wakes up the executor. The queue lock must be held.
+             */
+            void Enqueue(MessageBase Msg)
+            {
+                m_Queue.push(Msg);
+
+                if(!m_Executor)
+                {
+                    m_Signal.notify_one();
+                    return;
+                }
+
+                //One delivery task at a time keeps the messages in order.
+                if(!m_Scheduled)
+                {
+                    m_Scheduled = true;
+                    m_Executor->Post(m_Key, std::bind(&CMessageManager::Deliver, m_State, this));
+                }
+            }
+
+            /**
+             * @brief Delivers the queued messages on a thread of the shared pool.
+             */
+            static void Deliver(std::shared_ptr<SExecutorState> State, CMessageManager *Manager)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(State->Lock);
+                    if(State->Terminated)
+                        return;
+
+                    State->Running = true;
+                    State->Thread = std::this_thread::get_id();
+                }
+
+                {
+                    std::unique_lock<std::mutex> lock(Manager->m_QueueLock);
+                    while (!Manager->m_Terminated && !Manager->m_Queue.empty())
+                    {
+                        MessageBase Data = Manager->m_Queue.front();
+                        Manager->m_Queue.pop();
+
+                        lock.unlock();
+                        Manager->SendMessage(Data);
+                        lock.lock();
+                    }
+
+                    Manager->m_Scheduled = false;
+                }
+
+                std::lock_guard<std::mutex> lock(State->Lock);
+                State->Running = false;
+                State->Thread = std::thread::id();
+                State->Idle.notify_all();
+            }
+
             void Executor()
             {
+                std::unique_lock<std::mutex> lock(m_QueueLock);
                 while (!m_Terminated)
                 {
+                    if(m_Queue.empty())
                     {
-                        std::lock_guard<std::mutex> lock(m_QueueLock);
-                        if(!m_Queue.empty() && m_Queue.size() > 0)
-                        {
-                            MessageBase Data = m_Queue.front();
-                            m_Queue.pop();
-
-                            if(GetTimeMillis() - Data->CreateddMs > Data->Timeout)
-                                SendMessage(Data);
-                            else
-                                m_Queue.push(Data);
-                        }
+                        m_Signal.wait(lock);
+                        continue;
                     }
 
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                    MessageBase Data = m_Queue.front();
+                    m_Queue.pop();
+
+                    //Handlers are allowed to post new messages.
+                    lock.unlock();
+                    SendMessage(Data);
+                    lock.lock();
                 }
             }
 
@@ -152,11 +284,19 @@ namespace DiscordBot
                 }
             }
 
+            TimerService m_Timer;
             std::atomic<bool> m_Terminated;
             std::queue<MessageBase> m_Queue;
+            std::set<TimerID> m_Timers;     //!< Pending delayed messages.
             std::mutex m_QueueLock;
+            std::condition_variable m_Signal;
             std::mutex m_CallbackLock;
             std::thread m_Thread;
+
+            WorkerPool m_Executor;
+            std::shared_ptr<SExecutorState> m_State;
+            std::string m_Key;      //!< Ordering key inside the shared pool.
+            bool m_Scheduled;       //!< True if a delivery task is queued.
             std::multimap<size_t, OnMessageReceive> m_Callbacks;
     };
 } // namespace DiscordBot
@@ -0,0 +1,207 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "OutboundQueue.hpp"
+#include <algorithm>
+
+namespace DiscordBot
+{
+    const uint32_t COutboundQueue::LIMIT;
+    const uint32_t COutboundQueue::MARGIN;
+    const uint32_t COutboundQueue::PERIOD;
+    const uint32_t COutboundQueue::RESERVED;
+
+    COutboundQueue::COutboundQueue(TimerService Timer, SendFunc Send) : m_Timer(Timer), m_Send(Send), m_Connected(false), m_Ready(false), m_Sending(false), m_FlushTimer(CTimerService::INVALID_TIMER) {}
+
+    void COutboundQueue::Push(SendLane Lane, const std::string &Data, bool Binary)
+    {
+        std::unique_lock<std::mutex> lock(m_Lock);
+        auto &Queue = m_Lanes[(size_t)Lane];
+
+        //Only the latest presence matters, so a waiting presence is replaced.
+        if(Lane == SendLane::PRESENCE && !Queue.empty())
+        {
+            Queue.back().Data = Data;
+            Queue.back().Binary = Binary;
+        }
+        else
+            Queue.push_back({Data, Binary, Clock::now()});
+
+        Drain(lock);
+    }
+
+    void COutboundQueue::OnConnect()
+    {
+        std::unique_lock<std::mutex> lock(m_Lock);
+        m_Connected = true;
+        m_Ready = false;
+        m_Sent.clear();
+        m_Lanes[(size_t)SendLane::CONTROL].clear();
+        Drain(lock);
+    }
+
+    void COutboundQueue::OnReady()
+    {
+        std::unique_lock<std::mutex> lock(m_Lock);
+        m_Ready = true;
+        Drain(lock);
+    }
+
+    void COutboundQueue::OnDisconnect()
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        m_Connected = false;
+        m_Ready = false;
+    }
+
+    size_t COutboundQueue::GetDepth()
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+
+        size_t Ret = 0;
+        for (auto &&e : m_Lanes)
+            Ret += e.size();
+
+        return Ret;
+    }
+
+    uint32_t COutboundQueue::GetWaitTime()
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+
+        Clock::time_point Now = Clock::now();
+        Clock::time_point Oldest = Now;
+        for (auto &&e : m_Lanes)
+        {
+            if(!e.empty())
+                Oldest = std::min(Oldest, e.front().Queued);
+        }
+
+        return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(Now - Oldest).count();
+    }
+
+    uint32_t COutboundQueue::GetTokens()
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        Prune(Clock::now());
+
+        size_t Budget = LIMIT - MARGIN;
+        return m_Sent.size() < Budget ? (uint32_t)(Budget - m_Sent.size()) : 0;
+    }
+
+    void COutboundQueue::Prune(Clock::time_point Now)
+    {
+        while (!m_Sent.empty() && Now - m_Sent.front() >= std::chrono::milliseconds(PERIOD))
+            m_Sent.pop_front();
+    }
+
+    void COutboundQueue::Flush(std::vector<SCommand> &Commands)
+    {
+        if(!m_Connected)
+            return;
+
+        Clock::time_point Now = Clock::now();
+        Prune(Now);
+
+        size_t Allowed = 0;
+        bool Pending = false;
+        for (size_t i = 0; i < (size_t)SendLane::COUNT; i++)
+        {
+            if(i != (size_t)SendLane::CONTROL && !m_Ready)
+                break;
+
+            //The control lane can use the reserved commands.
+            Allowed = LIMIT - MARGIN - ((i == (size_t)SendLane::CONTROL) ? 0 : RESERVED);
+            auto &Lane = m_Lanes[i];
+
+            while (!Lane.empty() && m_Sent.size() < Allowed)
+            {
+                m_Sent.push_back(Now);
+                Commands.push_back(std::move(Lane.front()));
+                Lane.pop_front();
+            }
+
+            //Lower lanes must wait for the higher ones.
+            if(!Lane.empty())
+            {
+                Pending = true;
+                break;
+            }
+        }
+
+        if(Pending && m_FlushTimer == CTimerService::INVALID_TIMER)
+        {
+            //Time until enough sends left the window for the blocked lane.
+            Clock::time_point Free = m_Sent[m_Sent.size() - Allowed] + std::chrono::milliseconds(PERIOD);
+            uint32_t Delay = (uint32_t)std::max<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(Free - Now).count(), 1);
+            m_FlushTimer = m_Timer->Schedule(Delay, std::bind(&COutboundQueue::OnFlushTimer, this));
+        }
+    }
+
+    void COutboundQueue::Drain(std::unique_lock<std::mutex> &lock)
+    {
+        //The sending thread takes the new commands with its next flush.
+        if(m_Sending)
+            return;
+
+        m_Sending = true;
+
+        std::vector<SCommand> Commands;
+        Flush(Commands);
+
+        while (!Commands.empty())
+        {
+            lock.unlock();
+            for (auto &&e : Commands)
+                m_Send(e.Data, e.Binary);
+
+            Commands.clear();
+            lock.lock();
+
+            Flush(Commands);
+        }
+
+        m_Sending = false;
+    }
+
+    void COutboundQueue::OnFlushTimer()
+    {
+        std::unique_lock<std::mutex> lock(m_Lock);
+        m_FlushTimer = CTimerService::INVALID_TIMER;
+        Drain(lock);
+    }
+
+    COutboundQueue::~COutboundQueue()
+    {
+        TimerID ID;
+
+        {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            ID = m_FlushTimer;
+            m_Connected = false;
+        }
+
+        m_Timer->Cancel(ID);
+    }
+} // namespace DiscordBot
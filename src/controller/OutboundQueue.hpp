@@ -0,0 +1,154 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OUTBOUNDQUEUE_HPP
+#define OUTBOUNDQUEUE_HPP
+
+#include <functional>
+#include <deque>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <chrono>
+#include <stdint.h>
+#include "TimerService.hpp"
+
+namespace DiscordBot
+{
+    /**
+     * @brief Priority of a gateway command. Lower values are sent first.
+     */
+    enum class SendLane
+    {
+        CONTROL,        //!< Heartbeat, identify and resume.
+        VOICE,          //!< Voice state updates.
+        DEFAULT,        //!< All other commands.
+        PRESENCE,       //!< Presence updates. A queued presence is replaced by a newer one.
+        COUNT
+    };
+
+    /**
+     * @brief Rate limits the commands of one gateway connection with a sliding window. Discord closes connections which send more than 120 commands per 60 seconds.
+     */
+    class COutboundQueue
+    {
+        public:
+            using SendFunc = std::function<void(const std::string &Data, bool Binary)>;
+
+            static const uint32_t LIMIT = 120;          //!< Commands per period of discord.
+            static const uint32_t MARGIN = 10;          //!< Commands which are never used, so clock differences to discord don't close the connection.
+            static const uint32_t PERIOD = 60000;       //!< Period in milliseconds.
+            static const uint32_t RESERVED = 5;         //!< Commands which only can be used by the control lane, so heartbeats are never blocked.
+
+            /**
+             * @param Timer: Timer which sends the queued commands if the window allows it.
+             * @param Send: Function which writes to the socket.
+             */
+            COutboundQueue(TimerService Timer, SendFunc Send);
+
+            /**
+             * @brief Sends the command or queues it if the rate limit is reached.
+             */
+            void Push(SendLane Lane, const std::string &Data, bool Binary);
+
+            /**
+             * @brief Called if the connection is opened. The window is cleared, because the limit applies per connection. Stale control commands of the old connection are dropped.
+             * 
+             * @note Until OnReady() only the control lane is sent.
+             */
+            void OnConnect();
+
+            /**
+             * @brief Called if the session is identified or resumed. Sends the commands of all lanes.
+             */
+            void OnReady();
+
+            /**
+             * @brief Called if the connection is closed. Commands are queued until the next connect.
+             */
+            void OnDisconnect();
+
+            /**
+             * @return Returns the count of queued commands.
+             */
+            size_t GetDepth();
+
+            /**
+             * @return Returns the wait time of the oldest queued command in milliseconds.
+             */
+            uint32_t GetWaitTime();
+
+            /**
+             * @return Returns the count of commands which can be sent now.
+             */
+            uint32_t GetTokens();
+
+            ~COutboundQueue();
+
+        private:
+            using Clock = std::chrono::steady_clock;
+
+            struct SCommand
+            {
+                std::string Data;
+                bool Binary;
+                Clock::time_point Queued;
+            };
+
+            TimerService m_Timer;
+            SendFunc m_Send;
+
+            std::mutex m_Lock;
+            std::deque<SCommand> m_Lanes[(size_t)SendLane::COUNT];
+            std::deque<Clock::time_point> m_Sent;   //!< Send times of the current period.
+            bool m_Connected;
+            bool m_Ready;           //!< Discord closes the connection for commands before the identify.
+            bool m_Sending;         //!< True while a thread writes to the socket.
+            TimerID m_FlushTimer;
+
+            /**
+             * @brief Removes the send times which are older than one period.
+             */
+            void Prune(Clock::time_point Now);
+
+            /**
+             * @brief Takes the queued commands, which the window allows. Must be called with locked m_Lock.
+             * 
+             * @param Commands: Receives the commands to send.
+             */
+            void Flush(std::vector<SCommand> &Commands);
+
+            /**
+             * @brief Sends the commands of Flush without holding the lock. Only one thread sends at a time, so the commands keep their order.
+             * 
+             * @param lock: Locked m_Lock.
+             */
+            void Drain(std::unique_lock<std::mutex> &lock);
+
+            void OnFlushTimer();
+    };
+} // namespace DiscordBot
+
+
+#endif //OUTBOUNDQUEUE_HPP
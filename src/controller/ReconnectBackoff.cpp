@@ -0,0 +1,61 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ReconnectBackoff.hpp"
+#include <algorithm>
+
+namespace DiscordBot
+{
+    const uint32_t CReconnectBackoff::MAX_SHIFT;
+
+    CReconnectBackoff::CReconnectBackoff(uint32_t ResumeBase, uint32_t ResumeCap, uint32_t IdentifyBase, uint32_t IdentifyCap) : m_Random(std::random_device()()), m_ResumeBase(ResumeBase), m_ResumeCap(ResumeCap), m_IdentifyBase(IdentifyBase), m_IdentifyCap(IdentifyCap), m_Attempts(0) {}
+
+    uint32_t CReconnectBackoff::Next(bool Resumable)
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+
+        uint64_t Base = Resumable ? m_ResumeBase : m_IdentifyBase;
+        uint64_t Cap = Resumable ? m_ResumeCap : m_IdentifyCap;
+        uint64_t Ceil = std::min(Cap, Base << std::min(m_Attempts, MAX_SHIFT));
+
+        if(m_Attempts < UINT32_MAX)
+            m_Attempts++;
+
+        //Full jitter, the delay is somewhere between 0 and the exponential ceiling.
+        std::uniform_int_distribution<uint32_t> Dist(0, (uint32_t)Ceil);
+        return Dist(m_Random);
+    }
+
+    void CReconnectBackoff::Reset()
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        m_Attempts = 0;
+    }
+
+    uint32_t CReconnectBackoff::GetAttempts()
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        return m_Attempts;
+    }
+} // namespace DiscordBot
@@ -0,0 +1,78 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RECONNECTBACKOFF_HPP
+#define RECONNECTBACKOFF_HPP
+
+#include <mutex>
+#include <random>
+#include <stdint.h>
+
+namespace DiscordBot
+{
+    /**
+     * @brief Calculates reconnect delays with exponential backoff and full jitter.
+     * 
+     * Resumable failures start with a short delay, failures which needs a new identify start with a longer one.
+     * The random jitter staggers the reconnects of many connections which failed at the same time.
+     */
+    class CReconnectBackoff
+    {
+        public:
+            CReconnectBackoff(uint32_t ResumeBase = 1000, uint32_t ResumeCap = 30000, uint32_t IdentifyBase = 5000, uint32_t IdentifyCap = 120000);
+
+            /**
+             * @brief Calculates the next delay and increments the attempt counter.
+             * 
+             * @param Resumable: True if the session can be resumed.
+             * 
+             * @return Returns the delay in milliseconds.
+             */
+            uint32_t Next(bool Resumable);
+
+            /**
+             * @brief Resets the attempt counter. Call this if the connection is established.
+             */
+            void Reset();
+
+            /**
+             * @return Gets the count of failed attempts since the last reset.
+             */
+            uint32_t GetAttempts();
+
+        private:
+            static const uint32_t MAX_SHIFT = 16;   //!< Prevents overflows of the exponent.
+
+            std::mutex m_Lock;
+            std::mt19937 m_Random;
+            uint32_t m_ResumeBase;
+            uint32_t m_ResumeCap;
+            uint32_t m_IdentifyBase;
+            uint32_t m_IdentifyCap;
+            uint32_t m_Attempts;
+    };
+} // namespace DiscordBot
+
+
+#endif //RECONNECTBACKOFF_HPP
@@ -0,0 +1,167 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "SessionCheckpoint.hpp"
+#include "../models/Payload.hpp"
+#include <config.h>
+#include <Log.hpp>
+#include <fstream>
+#include <cstdio>
+
+namespace DiscordBot
+{
+    bool SSessionCheckpoint::Save(const std::string &File) const
+    {
+        std::string Shards;
+        for (auto &&e : this->Shards)
+        {
+            CJSON tmp;
+            Shards += (Shards.empty() ? "" : ",") + tmp.Serialize(e);
+        }
+
+        std::string Guilds;
+        for (auto &&e : this->Guilds)
+            Guilds += (Guilds.empty() ? "" : ",") + e;
+
+        std::string Voice;
+        for (auto &&e : VoiceSessions)
+        {
+            CJSON tmp;
+            Voice += (Voice.empty() ? "" : ",") + tmp.Serialize(e);
+        }
+
+        std::string Queued;
+        for (auto &&e : Songs)
+        {
+            CJSON tmp;
+            Queued += (Queued.empty() ? "" : ",") + tmp.Serialize(e);
+        }
+
+        CJSON json;
+        json.AddPair("timestamp", Timestamp);
+        json.AddPair("shard_count", ShardCount);
+        json.AddJSON("shards", "[" + Shards + "]");
+        json.AddJSON("guilds", "[" + Guilds + "]");
+        json.AddJSON("voice", "[" + Voice + "]");
+        json.AddJSON("songs", "[" + Queued + "]");
+
+        std::string Tmp = File + ".tmp";
+        std::ofstream out(Tmp, std::ios::out | std::ios::trunc);
+        if(!out.is_open())
+        {
+            llog << lerror << "Failed to write the session checkpoint " << Tmp << lendl;
+            return false;
+        }
+
+        out << json.Serialize();
+        out.close();
+
+        if(out.fail())
+        {
+            llog << lerror << "Failed to write the session checkpoint " << Tmp << lendl;
+            return false;
+        }
+
+#ifdef DISCORDBOT_WINDOWS
+        //Windows doesn't replace existing files.
+        std::remove(File.c_str());
+#endif
+
+        return std::rename(Tmp.c_str(), File.c_str()) == 0;
+    }
+
+    bool SSessionCheckpoint::Load(const std::string &File)
+    {
+        std::ifstream in(File, std::ios::in);
+        if(!in.is_open())
+            return false;
+
+        std::string str((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+
+        try
+        {
+            CJSON json;
+            json.ParseObject(str);
+
+            Timestamp = json.GetValue<int64_t>("timestamp");
+            ShardCount = json.GetValue<uint32_t>("shard_count");
+
+            Shards.clear();
+            for (auto &&e : json.GetValue<std::vector<std::string>>("shards"))
+            {
+                CJSON tmp;
+                Shards.push_back(tmp.Deserialize<SShardSession>(e));
+            }
+        }
+        catch (const CJSONException &e)
+        {
+            llog << lerror << "Failed to parse the session checkpoint Enumtype: " << GetEnumName(e.GetErrType()) << " what(): " << e.what() << lendl;
+            return false;
+        }
+
+        Guilds.clear();
+        VoiceSessions.clear();
+        Songs.clear();
+
+        //Only handoff checkpoints contain the caches.
+        try
+        {
+            CJSON json;
+            json.ParseObject(str);
+
+            Guilds = json.GetValue<std::vector<std::string>>("guilds");
+            for (auto &&e : json.GetValue<std::vector<std::string>>("voice"))
+            {
+                CJSON tmp;
+                VoiceSessions.push_back(tmp.Deserialize<SVoiceSession>(e));
+            }
+        }
+        catch (const CJSONException &e)
+        {
+            //Checkpoints of older versions only contain the sessions.
+            Guilds.clear();
+            VoiceSessions.clear();
+        }
+
+        try
+        {
+            CJSON json;
+            json.ParseObject(str);
+
+            for (auto &&e : json.GetValue<std::vector<std::string>>("songs"))
+            {
+                CJSON tmp;
+                Songs.push_back(tmp.Deserialize<SQueuedSong>(e));
+            }
+        }
+        catch (const CJSONException &e)
+        {
+            //Checkpoints of older versions don't contain the music queues.
+            Songs.clear();
+        }
+
+        return true;
+    }
+} // namespace DiscordBot
@@ -0,0 +1,141 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SESSIONCHECKPOINT_HPP
+#define SESSIONCHECKPOINT_HPP
+
+#include <JSON.hpp>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace DiscordBot
+{
+    /**
+     * @brief Session of one shard which can be resumed.
+     */
+    struct SShardSession
+    {
+        uint32_t ID;
+        std::string SessionID;
+        uint32_t Seq;
+        std::string ResumeURL;
+
+        void Serialize(CJSON &json) const
+        {
+            json.AddPair("id", ID);
+            json.AddPair("session_id", SessionID);
+            json.AddPair("seq", Seq);
+            json.AddPair("resume_url", ResumeURL);
+        }
+
+        void Deserialize(CJSON &json)
+        {
+            ID = json.GetValue<uint32_t>("id");
+            SessionID = json.GetValue<std::string>("session_id");
+            Seq = json.GetValue<uint32_t>("seq");
+            ResumeURL = json.GetValue<std::string>("resume_url");
+        }
+    };
+
+    /**
+     * @brief Voice channel of the bot, which is joined again after a handoff.
+     */
+    struct SVoiceSession
+    {
+        std::string GuildID;
+        std::string ChannelID;
+
+        void Serialize(CJSON &json) const
+        {
+            json.AddPair("guild_id", GuildID);
+            json.AddPair("channel_id", ChannelID);
+        }
+
+        void Deserialize(CJSON &json)
+        {
+            GuildID = json.GetValue<std::string>("guild_id");
+            ChannelID = json.GetValue<std::string>("channel_id");
+        }
+    };
+
+    /**
+     * @brief Song of a music queue, which is queued again after a handoff.
+     */
+    struct SQueuedSong
+    {
+        std::string GuildID;
+        std::string Name;
+        std::string Path;
+        std::string Duration;
+
+        void Serialize(CJSON &json) const
+        {
+            json.AddPair("guild_id", GuildID);
+            json.AddPair("name", Name);
+            json.AddPair("path", Path);
+            json.AddPair("duration", Duration);
+        }
+
+        void Deserialize(CJSON &json)
+        {
+            GuildID = json.GetValue<std::string>("guild_id");
+            Name = json.GetValue<std::string>("name");
+            Path = json.GetValue<std::string>("path");
+            Duration = json.GetValue<std::string>("duration");
+        }
+    };
+
+    /**
+     * @brief Sessions of all shards of this process, which are stored on disk to resume after a restart.
+     * 
+     * A handoff checkpoint also contains the cached guilds, the voice channels and the music queues, because a resumed session doesn't receive them again.
+     */
+    struct SSessionCheckpoint
+    {
+        SSessionCheckpoint() : Timestamp(0), ShardCount(0) {}
+
+        int64_t Timestamp;          //!< Creation time in milliseconds since epoch.
+        uint32_t ShardCount;
+        std::vector<SShardSession> Shards;
+        std::vector<std::string> Guilds;            //!< Cached guilds in the format of the GUILD_CREATE event.
+        std::vector<SVoiceSession> VoiceSessions;
+        std::vector<SQueuedSong> Songs;             //!< Songs of all music queues in queue order. The first song of a guild was playing.
+
+        /**
+         * @brief Writes the checkpoint atomically. The data is written to a temporary file, which replaces the old checkpoint.
+         * 
+         * @return Returns false if the file couldn't be written.
+         */
+        bool Save(const std::string &File) const;
+
+        /**
+         * @return Returns false if the file doesn't exists or is invalid.
+         */
+        bool Load(const std::string &File);
+    };
+} // namespace DiscordBot
+
+
+#endif //SESSIONCHECKPOINT_HPP
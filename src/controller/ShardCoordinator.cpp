@@ -0,0 +1,318 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ShardCoordinator.hpp"
+#include <ixwebsocket/IXNetSystem.h>
+#include <Log.hpp>
+#include "../models/Payload.hpp"
+#include "../helpers/Helper.hpp"
+
+namespace DiscordBot
+{
+    const int CShardCoordinator::IDENTIFY_DELAY;
+    const int CShardCoordinator::QUERY_TIMEOUT;
+
+    ShardCoordinator IShardCoordinator::Create(uint32_t TotalShards, uint32_t Processes, uint32_t MaxConcurrency, int Port, const std::string &Host)
+    {
+        //Needed for windows.
+        ix::initNetSystem();
+
+        return ShardCoordinator(new CShardCoordinator(TotalShards, Processes, MaxConcurrency, Port, Host));
+    }
+
+    CShardCoordinator::CShardCoordinator(uint32_t TotalShards, uint32_t Processes, uint32_t MaxConcurrency, int Port, const std::string &Host) : m_Server(Port, Host), m_TotalShards(std::max<uint32_t>(TotalShards, 1)), m_MaxConcurrency(std::max<uint32_t>(MaxConcurrency, 1)), m_Quit(false), m_NextNonce(0)
+    {
+        Processes = std::max<uint32_t>(std::min(Processes, m_TotalShards), 1);
+        m_Slots.resize(Processes);
+
+        //Splits the shards into continuous ranges.
+        for (uint32_t i = 0; i < m_TotalShards; i++)
+            m_Slots[i * Processes / m_TotalShards].Shards.push_back(i);
+
+        m_LastIdentify.resize(m_MaxConcurrency, 0);
+        m_Server.setOnClientMessageCallback(std::bind(&CShardCoordinator::OnClientMessage, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+    }
+
+    void CShardCoordinator::Run()
+    {
+        auto Res = m_Server.listen();
+        if(!Res.first)
+        {
+            llog << lerror << "Failed to start the shard coordinator: " << Res.second << lendl;
+            return;
+        }
+
+        m_Server.start();
+        llog << linfo << "Shard coordinator started. Shards: " << m_TotalShards << " Processes: " << m_Slots.size() << lendl;
+
+        //Runs until the coordinator quits.
+        while (!m_Quit)
+        {
+            ProcessQueues();
+
+            std::unique_lock<std::mutex> lock(m_Lock);
+            m_Signal.wait_for(lock, std::chrono::milliseconds(100));
+        }
+
+        m_Server.stop();
+    }
+
+    void CShardCoordinator::Quit()
+    {
+        m_Quit = true;
+        m_Signal.notify_all();
+    }
+
+    void CShardCoordinator::OnClientMessage(std::shared_ptr<ix::ConnectionState> State, ix::WebSocket &Socket, const ix::WebSocketMessagePtr &msg)
+    {
+        switch (msg->type)
+        {
+            case ix::WebSocketMessageType::Open:
+            {
+                std::lock_guard<std::mutex> lock(m_Lock);
+                m_Connections[State->getId()] = &Socket;
+            }break;
+
+            case ix::WebSocketMessageType::Close:
+            {
+                OnDisconnect(State->getId());
+            }break;
+
+            case ix::WebSocketMessageType::Message:
+            {
+                try
+                {
+                    CJSON json;
+                    json.ParseObject(msg->str);
+
+                    switch (Adler32(json.GetValue<std::string>("op").c_str()))
+                    {
+                        case Adler32("hello"):
+                        {
+                            OnHello(State->getId());
+                        }break;
+
+                        case Adler32("identify"):
+                        {
+                            std::lock_guard<std::mutex> lock(m_Lock);
+                            m_IdentifyQueue.push_back({State->getId(), json.GetValue<uint32_t>("shard")});
+                            m_Signal.notify_all();
+                        }break;
+
+                        case Adler32("query"):
+                        {
+                            OnQuery(State->getId(), json);
+                        }break;
+
+                        case Adler32("query_result"):
+                        {
+                            OnQueryResult(State->getId(), json);
+                        }break;
+                    }
+                }
+                catch (const CJSONException &e)
+                {
+                    llog << lerror << "Failed to parse coordinator message JSON Enumtype: " << GetEnumName(e.GetErrType()) << " what(): " << e.what() << lendl;
+                }
+            }break;
+
+            default:
+                break;
+        }
+    }
+
+    void CShardCoordinator::ProcessQueues()
+    {
+        std::vector<std::string> Finished;
+
+        {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            int64_t Now = GetTimeMillis();
+
+            //Grants one identify per bucket and delay.
+            auto IT = m_IdentifyQueue.begin();
+            while (IT != m_IdentifyQueue.end())
+            {
+                uint32_t Bucket = IT->ShardID % m_MaxConcurrency;
+                if(Now - m_LastIdentify[Bucket] >= IDENTIFY_DELAY)
+                {
+                    m_LastIdentify[Bucket] = Now;
+
+                    CJSON json;
+                    json.AddPair("op", std::string("identify_granted"));
+                    json.AddPair("shard", IT->ShardID);
+                    Send(IT->ConnectionID, json.Serialize());
+
+                    IT = m_IdentifyQueue.erase(IT);
+                }
+                else
+                    IT++;
+            }
+
+            for (auto &&e : m_Queries)
+            {
+                if(e.second.Pending.empty() || Now >= e.second.Deadline)
+                    Finished.push_back(e.first);
+            }
+        }
+
+        for (auto &&e : Finished)
+            FinishQuery(e);
+    }
+
+    void CShardCoordinator::OnHello(const std::string &ConnectionID)
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+
+        //Assigns the first free slot.
+        for (auto &&e : m_Slots)
+        {
+            if(e.ConnectionID.empty())
+            {
+                e.ConnectionID = ConnectionID;
+
+                CJSON json;
+                json.AddPair("op", std::string("assign"));
+                json.AddPair("shards", e.Shards);
+                json.AddPair("total", m_TotalShards);
+                Send(ConnectionID, json.Serialize());
+
+                llog << linfo << "Process " << ConnectionID << " joined the cluster with " << e.Shards.size() << " shards" << lendl;
+                return;
+            }
+        }
+
+        //All shards are assigned.
+        CJSON json;
+        json.AddPair("op", std::string("assign"));
+        json.AddPair("shards", std::vector<uint32_t>());
+        json.AddPair("total", m_TotalShards);
+        Send(ConnectionID, json.Serialize());
+
+        llog << lerror << "No free shards for process " << ConnectionID << lendl;
+    }
+
+    void CShardCoordinator::OnDisconnect(const std::string &ConnectionID)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            m_Connections.erase(ConnectionID);
+
+            //Frees the shards of the process, so a new process can take them.
+            for (auto &&e : m_Slots)
+            {
+                if(e.ConnectionID == ConnectionID)
+                {
+                    e.ConnectionID.clear();
+                    llog << linfo << "Process " << ConnectionID << " left the cluster" << lendl;
+                }
+            }
+
+            m_IdentifyQueue.remove_if([&ConnectionID](const SIdentifyRequest &r)
+            {
+                return r.ConnectionID == ConnectionID;
+            });
+
+            for (auto &&e : m_Queries)
+                e.second.Pending.erase(ConnectionID);
+        }
+
+        m_Signal.notify_all();
+    }
+
+    void CShardCoordinator::OnQuery(const std::string &ConnectionID, CJSON &json)
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+
+        std::string Nonce = std::to_string(m_NextNonce++);
+        SQuery &Query = m_Queries[Nonce];
+        Query.RequesterID = ConnectionID;
+        Query.Nonce = json.GetValue<std::string>("nonce");
+        Query.Deadline = GetTimeMillis() + QUERY_TIMEOUT;
+
+        CJSON Relay;
+        Relay.AddPair("op", std::string("query"));
+        Relay.AddPair("nonce", Nonce);
+        Relay.AddPair("type", json.GetValue<std::string>("type"));
+        std::string Msg = Relay.Serialize();
+
+        //The requester answers the query by itself.
+        for (auto &&e : m_Connections)
+        {
+            if(e.first != ConnectionID)
+            {
+                Query.Pending.insert(e.first);
+                e.second->send(Msg);
+            }
+        }
+
+        m_Signal.notify_all();
+    }
+
+    void CShardCoordinator::OnQueryResult(const std::string &ConnectionID, CJSON &json)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Lock);
+
+            auto IT = m_Queries.find(json.GetValue<std::string>("nonce"));
+            if(IT == m_Queries.end())
+                return;
+
+            auto Data = json.GetValue<std::vector<std::string>>("data");
+            IT->second.Data.insert(IT->second.Data.end(), Data.begin(), Data.end());
+            IT->second.Pending.erase(ConnectionID);
+        }
+
+        m_Signal.notify_all();
+    }
+
+    void CShardCoordinator::FinishQuery(const std::string &Nonce)
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+
+        auto IT = m_Queries.find(Nonce);
+        if(IT == m_Queries.end())
+            return;
+
+        CJSON json;
+        json.AddPair("op", std::string("query_result"));
+        json.AddPair("nonce", IT->second.Nonce);
+        json.AddPair("data", IT->second.Data);
+        Send(IT->second.RequesterID, json.Serialize());
+
+        m_Queries.erase(IT);
+    }
+
+    void CShardCoordinator::Send(const std::string &ConnectionID, const std::string &Msg)
+    {
+        auto IT = m_Connections.find(ConnectionID);
+        if(IT != m_Connections.end())
+            IT->second->send(Msg);
+    }
+
+    CShardCoordinator::~CShardCoordinator()
+    {
+        Quit();
+    }
+} // namespace DiscordBot
@@ -0,0 +1,123 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SHARDCOORDINATOR_HPP
+#define SHARDCOORDINATOR_HPP
+
+#include <IShardCoordinator.hpp>
+#include <ixwebsocket/IXWebSocketServer.h>
+#include <JSON.hpp>
+#include <map>
+#include <set>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace DiscordBot
+{
+    /**
+     * @brief Coordinator of a shard cluster. Each process connects via websocket and receives its shard range.
+     * 
+     * Protocol (json):
+     *  - hello             client -> coordinator   Requests a shard range.
+     *  - assign            coordinator -> client   Contains the shards of the process and the total count.
+     *  - identify          client -> coordinator   Requests an identify for a shard.
+     *  - identify_granted  coordinator -> client   The shard is allowed to identify.
+     *  - query             both directions         Cross process query. The coordinator relays the query to all other processes.
+     *  - query_result      both directions         Result of a query.
+     */
+    class CShardCoordinator : public IShardCoordinator
+    {
+        public:
+            CShardCoordinator(uint32_t TotalShards, uint32_t Processes, uint32_t MaxConcurrency, int Port, const std::string &Host);
+
+            void Run() override;
+            void Quit() override;
+
+            ~CShardCoordinator();
+
+        private:
+            static const int IDENTIFY_DELAY = 5000;     //!< Delay between two identifies of the same bucket.
+            static const int QUERY_TIMEOUT = 5000;
+
+            /**
+             * @brief Range of shards which is assigned to one process.
+             */
+            struct SSlot
+            {
+                std::string ConnectionID;
+                std::vector<uint32_t> Shards;
+            };
+
+            struct SIdentifyRequest
+            {
+                std::string ConnectionID;
+                uint32_t ShardID;
+            };
+
+            struct SQuery
+            {
+                std::string RequesterID;
+                std::string Nonce;
+                std::set<std::string> Pending;      //!< Connections which doesn't answered yet.
+                std::vector<std::string> Data;
+                int64_t Deadline;
+            };
+
+            ix::WebSocketServer m_Server;
+            uint32_t m_TotalShards;
+            uint32_t m_MaxConcurrency;
+
+            std::mutex m_Lock;
+            std::condition_variable m_Signal;
+            std::atomic<bool> m_Quit;
+
+            std::map<std::string, ix::WebSocket*> m_Connections;
+            std::vector<SSlot> m_Slots;
+            std::list<SIdentifyRequest> m_IdentifyQueue;
+            std::vector<int64_t> m_LastIdentify;        //!< Last identify per concurrency bucket.
+            std::map<std::string, SQuery> m_Queries;
+            uint64_t m_NextNonce;
+
+            void OnClientMessage(std::shared_ptr<ix::ConnectionState> State, ix::WebSocket &Socket, const ix::WebSocketMessagePtr &msg);
+
+            /**
+             * @brief Grants pending identifies and finishes timed out queries.
+             */
+            void ProcessQueues();
+
+            void OnHello(const std::string &ConnectionID);
+            void OnDisconnect(const std::string &ConnectionID);
+            void OnQuery(const std::string &ConnectionID, CJSON &json);
+            void OnQueryResult(const std::string &ConnectionID, CJSON &json);
+            void FinishQuery(const std::string &Nonce);
+
+            void Send(const std::string &ConnectionID, const std::string &Msg);
+    };
+} // namespace DiscordBot
+
+
+#endif //SHARDCOORDINATOR_HPP
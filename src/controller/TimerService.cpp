@@ -0,0 +1,133 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "TimerService.hpp"
+
+namespace DiscordBot
+{
+    const TimerID CTimerService::INVALID_TIMER;
+
+    CTimerService::CTimerService() : m_Terminate(false), m_NextID(1), m_Running(INVALID_TIMER)
+    {
+        m_Thread = std::thread(&CTimerService::Executor, this);
+    }
+
+    TimerID CTimerService::Schedule(uint32_t Delay, TimerCallback Callback, uint32_t Interval)
+    {
+        TimerID ID;
+
+        {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            ID = m_NextID++;
+
+            m_Timers[ID] = {Callback, Interval};
+            m_Queue.push({Clock::now() + std::chrono::milliseconds(Delay), ID});
+        }
+
+        m_Signal.notify_all();
+        return ID;
+    }
+
+    void CTimerService::Cancel(TimerID ID)
+    {
+        if(ID == INVALID_TIMER)
+            return;
+
+        std::unique_lock<std::mutex> lock(m_Lock);
+        m_Timers.erase(ID);
+
+        //Waits for a running callback, except it cancels itself.
+        if(std::this_thread::get_id() != m_Thread.get_id())
+            m_Signal.wait(lock, [this, ID]{ return m_Running != ID; });
+    }
+
+    void CTimerService::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            m_Terminate = true;
+            m_Timers.clear();
+        }
+
+        m_Signal.notify_all();
+        if(m_Thread.joinable() && m_Thread.get_id() != std::this_thread::get_id())
+            m_Thread.join();
+    }
+
+    void CTimerService::Executor()
+    {
+        std::unique_lock<std::mutex> lock(m_Lock);
+        while (!m_Terminate)
+        {
+            if(m_Queue.empty())
+            {
+                m_Signal.wait(lock);
+                continue;
+            }
+
+            SEntry Entry = m_Queue.top();
+
+            //Removes cancelled timers.
+            auto IT = m_Timers.find(Entry.ID);
+            if(IT == m_Timers.end())
+            {
+                m_Queue.pop();
+                continue;
+            }
+
+            if(Entry.Due > Clock::now())
+            {
+                m_Signal.wait_until(lock, Entry.Due);
+                continue;
+            }
+
+            m_Queue.pop();
+            TimerCallback Callback = IT->second.Callback;
+            m_Running = Entry.ID;
+
+            lock.unlock();
+            Callback();
+            lock.lock();
+
+            m_Running = INVALID_TIMER;
+
+            //The timer could be cancelled inside the callback.
+            IT = m_Timers.find(Entry.ID);
+            if(IT != m_Timers.end())
+            {
+                if(IT->second.Interval != 0)
+                    m_Queue.push({Entry.Due + std::chrono::milliseconds(IT->second.Interval), Entry.ID});
+                else
+                    m_Timers.erase(IT);
+            }
+
+            m_Signal.notify_all();
+        }
+    }
+
+    CTimerService::~CTimerService()
+    {
+        Stop();
+    }
+} // namespace DiscordBot
@@ -0,0 +1,120 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TIMERSERVICE_HPP
+#define TIMERSERVICE_HPP
+
+#include <functional>
+#include <queue>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <memory>
+#include <stdint.h>
+
+namespace DiscordBot
+{
+    using TimerID = uint64_t;
+
+    /**
+     * @brief Runs all timers of the bot on one thread. The timers are stored in a min-heap and use the steady clock.
+     * 
+     * @note Callbacks are executed on the timer thread, so they shouldn't block.
+     */
+    class CTimerService
+    {
+        public:
+            using TimerCallback = std::function<void()>;
+
+            static const TimerID INVALID_TIMER = 0;
+
+            CTimerService();
+
+            /**
+             * @brief Schedules a callback.
+             * 
+             * @param Delay: Delay in milliseconds until the first call.
+             * @param Callback: Function to call.
+             * @param Interval: Interval in milliseconds for repeating timers or 0 for a one-shot timer.
+             * 
+             * @return Returns the id of the timer.
+             */
+            TimerID Schedule(uint32_t Delay, TimerCallback Callback, uint32_t Interval = 0);
+
+            /**
+             * @brief Removes a timer. Can be called inside a timer callback.
+             * 
+             * @note If the callback of the timer is running on another thread, the call waits until the callback has finished. After the call it is safe to destroy the objects of the callback.
+             */
+            void Cancel(TimerID ID);
+
+            /**
+             * @brief Stops the timer thread. Pending timers are dropped.
+             */
+            void Stop();
+
+            ~CTimerService();
+
+        private:
+            using Clock = std::chrono::steady_clock;
+
+            struct STimer
+            {
+                TimerCallback Callback;
+                uint32_t Interval;
+            };
+
+            struct SEntry
+            {
+                Clock::time_point Due;
+                TimerID ID;
+
+                bool operator>(const SEntry &rhs) const
+                {
+                    return Due > rhs.Due;
+                }
+            };
+
+            std::mutex m_Lock;
+            std::condition_variable m_Signal;
+            bool m_Terminate;
+
+            std::priority_queue<SEntry, std::vector<SEntry>, std::greater<SEntry>> m_Queue;
+            std::map<TimerID, STimer> m_Timers;     //!< Cancelled timers are removed from here and skipped in the queue.
+            TimerID m_NextID;
+            TimerID m_Running;                      //!< Timer whose callback is executed.
+
+            std::thread m_Thread;
+
+            void Executor();
+    };
+
+    using TimerService = std::shared_ptr<CTimerService>;
+} // namespace DiscordBot
+
+
+#endif //TIMERSERVICE_HPP
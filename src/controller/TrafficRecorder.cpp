@@ -0,0 +1,146 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "TrafficRecorder.hpp"
+#include <algorithm>
+#include <Log.hpp>
+
+namespace DiscordBot
+{
+    namespace
+    {
+        const char MAGIC[4] = {'D', 'B', 'T', 'R'};
+        const uint8_t FILE_VERSION = 2;
+
+        const uint8_t FLAG_COMPRESSED = 1;
+        const uint8_t FLAG_ETF = 2;
+
+        template<class T>
+        void WriteInt(std::ofstream &Out, T Val)
+        {
+            char Buf[sizeof(T)];
+            for (size_t i = 0; i < sizeof(T); i++)
+                Buf[i] = (char)(((uint64_t)Val >> (i * 8)) & 0xFF);
+
+            Out.write(Buf, sizeof(T));
+        }
+
+        template<class T>
+        bool ReadInt(std::ifstream &In, T &Val)
+        {
+            unsigned char Buf[sizeof(T)];
+            if(!In.read((char*)Buf, sizeof(T)))
+                return false;
+
+            uint64_t Tmp = 0;
+            for (size_t i = 0; i < sizeof(T); i++)
+                Tmp |= (uint64_t)Buf[i] << (i * 8);
+
+            Val = (T)Tmp;
+            return true;
+        }
+    }
+
+    bool CTrafficRecorder::Open(const std::string &File, const STrafficInfo &Info)
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        m_Out.open(File, std::ios::out | std::ios::binary | std::ios::trunc);
+        if(!m_Out.is_open())
+        {
+            llog << lerror << "Failed to create the traffic record " << File << lendl;
+            return false;
+        }
+
+        m_Out.write(MAGIC, sizeof(MAGIC));
+        WriteInt<uint8_t>(m_Out, FILE_VERSION);
+        WriteInt<uint32_t>(m_Out, Info.ShardCount);
+        WriteInt<uint8_t>(m_Out, (uint8_t)Info.GatewayVersion);
+        WriteInt<uint8_t>(m_Out, (uint8_t)((Info.Compressed ? FLAG_COMPRESSED : 0) | (Info.Encoding == GatewayEncoding::ETF ? FLAG_ETF : 0)));
+
+        //The steady clock isn't changed by wall clock adjustments during the recording.
+        m_Start = std::chrono::steady_clock::now();
+
+        return true;
+    }
+
+    void CTrafficRecorder::Write(uint32_t ShardID, FrameType Type, const std::string &Data)
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        if(!m_Out.is_open())
+            return;
+
+        WriteInt<int64_t>(m_Out, std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_Start).count());
+        WriteInt<uint32_t>(m_Out, ShardID);
+        WriteInt<uint8_t>(m_Out, (uint8_t)Type);
+        WriteInt<uint32_t>(m_Out, (uint32_t)Data.size());
+        m_Out.write(Data.data(), Data.size());
+    }
+
+    void CTrafficRecorder::Close()
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        if(m_Out.is_open())
+            m_Out.close();
+    }
+
+    bool CTrafficReader::Open(const std::string &File)
+    {
+        m_In.open(File, std::ios::in | std::ios::binary);
+        if(!m_In.is_open())
+            return false;
+
+        char Magic[sizeof(MAGIC)];
+        uint8_t Version;
+        if(!m_In.read(Magic, sizeof(Magic)) || !std::equal(Magic, Magic + sizeof(Magic), MAGIC) || !ReadInt(m_In, Version) || Version != FILE_VERSION)
+        {
+            llog << lerror << "Invalid traffic record " << File << lendl;
+            return false;
+        }
+
+        uint8_t GatewayVersion, Flags;
+        if(!ReadInt(m_In, m_Info.ShardCount) || !ReadInt(m_In, GatewayVersion) || !ReadInt(m_In, Flags))
+            return false;
+
+        m_Info.GatewayVersion = GatewayVersion;
+        m_Info.Compressed = (Flags & FLAG_COMPRESSED) != 0;
+        m_Info.Encoding = (Flags & FLAG_ETF) != 0 ? GatewayEncoding::ETF : GatewayEncoding::JSON;
+
+        return true;
+    }
+
+    bool CTrafficReader::Read(STrafficRecord &Record)
+    {
+        uint8_t Type;
+        uint32_t Length;
+
+        if(!ReadInt(m_In, Record.Timestamp) || !ReadInt(m_In, Record.ShardID) || !ReadInt(m_In, Type) || !ReadInt(m_In, Length))
+            return false;
+
+        Record.Type = (FrameType)Type;
+        Record.Data.resize(Length);
+
+        //A truncated record is the end of a file which was written during a crash.
+        return Length == 0 || m_In.read(&Record.Data[0], Length);
+    }
+} // namespace DiscordBot
@@ -0,0 +1,130 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TRAFFICRECORDER_HPP
+#define TRAFFICRECORDER_HPP
+
+#include <IDiscordClient.hpp>
+#include <string>
+#include <fstream>
+#include <mutex>
+#include <chrono>
+#include <stdint.h>
+
+namespace DiscordBot
+{
+    /**
+     * @brief Type of a recorded websocket frame.
+     */
+    enum class FrameType : uint8_t
+    {
+        OPEN,
+        CLOSE,
+        TEXT,
+        BINARY
+    };
+
+    /**
+     * @brief Connection settings of a recording, which are needed to decode the frames.
+     */
+    struct STrafficInfo
+    {
+        STrafficInfo() : ShardCount(0), GatewayVersion(0), Compressed(false), Encoding(GatewayEncoding::JSON) {}
+
+        uint32_t ShardCount;
+        uint32_t GatewayVersion;
+        bool Compressed;            //!< True if the frames are "zlib-stream" compressed.
+        GatewayEncoding Encoding;
+    };
+
+    /**
+     * @brief One received websocket frame.
+     */
+    struct STrafficRecord
+    {
+        int64_t Timestamp;      //!< Receive time in milliseconds since the start of the recording.
+        uint32_t ShardID;
+        FrameType Type;
+        std::string Data;       //!< Raw frame, before decompression and decoding.
+    };
+
+    /**
+     * @brief Appends all received gateway frames to a file.
+     * 
+     * File layout (little endian):
+     *  Header: "DBTR" | uint8 version | uint32 shard count | uint8 gateway version | uint8 flags (1 = zlib-stream, 2 = etf)
+     *  Record: int64 timestamp | uint32 shard | uint8 type | uint32 length | data
+     */
+    class CTrafficRecorder
+    {
+        public:
+            /**
+             * @return Returns false if the file couldn't be created.
+             */
+            bool Open(const std::string &File, const STrafficInfo &Info);
+
+            /**
+             * @brief Appends a frame. Thread safe.
+             */
+            void Write(uint32_t ShardID, FrameType Type, const std::string &Data);
+
+            void Close();
+
+        private:
+            std::mutex m_Lock;
+            std::ofstream m_Out;
+            std::chrono::steady_clock::time_point m_Start;
+    };
+
+    /**
+     * @brief Reads a file of the CTrafficRecorder.
+     */
+    class CTrafficReader
+    {
+        public:
+            CTrafficReader() {}
+
+            /**
+             * @return Returns false if the file doesn't exists or has an invalid header.
+             */
+            bool Open(const std::string &File);
+
+            /**
+             * @return Reads the next record. Returns false at the end of the file.
+             */
+            bool Read(STrafficRecord &Record);
+
+            const STrafficInfo &GetInfo() const
+            {
+                return m_Info;
+            }
+
+        private:
+            std::ifstream m_In;
+            STrafficInfo m_Info;
+    };
+} // namespace DiscordBot
+
+
+#endif //TRAFFICRECORDER_HPP
@@ -40,8 +40,9 @@ namespace DiscordBot
      * @param json: JSON from VOICE_SERVER_UPDATE event,
      * @param SessionID: Session ID of the bot voice state.
      * @param ClientID: Bot client ID.
+     * @param Timer: Timer for the heartbeat.
      */
-    CVoiceSocket::CVoiceSocket(CJSON &json, const std::string &SessionID, const std::string &ClientID) : m_Terminate(false), m_HeartACKReceived(false), m_LastSeqNum(-1), m_Stop(true), m_Reconnect(false)
+    CVoiceSocket::CVoiceSocket(CJSON &json, const std::string &SessionID, const std::string &ClientID, TimerService Timer, WorkerPool Executor) : m_Timer(Timer), m_EVManager(Timer, Executor), m_HeartbeatTimer(CTimerService::INVALID_TIMER), m_Terminate(false), m_HeartACKReceived(false), m_LastSeqNum(-1), m_Stop(true), m_Reconnect(false), m_ReconnectPending(false)
     {
         m_EVManager.SubscribeMessage(RESUME, std::bind(&CVoiceSocket::OnMessageReceive, this, std::placeholders::_1));   
 
@@ -58,6 +59,7 @@ namespace DiscordBot
         DisabledTrust.caFile = "NONE";
 
         m_Socket.setTLSOptions(DisabledTrust);
+        m_Socket.disableAutomaticReconnection();
         m_Socket.setUrl("wss://" + URL + "/?v=4");
         m_Socket.setOnMessageCallback(std::bind(&CVoiceSocket::OnWebsocketEvent, this, std::placeholders::_1));
         m_Socket.start();
@@ -130,6 +132,20 @@ namespace DiscordBot
         m_Source = nullptr;
     }
 
+    /**
+     * @brief Stops the sending of audio without a OnSpeakFinish event.
+     */
+    AudioSource CVoiceSocket::DetachSource()
+    {
+        m_Stop = true;
+        if(m_Playback.joinable())
+            m_Playback.join();
+
+        AudioSource Ret = m_Source;
+        m_Source = nullptr;
+        return Ret;
+    }
+
     /**
      * @brief Informates Discord that the bot begins to speak or is finish with speaking.
      */
@@ -344,6 +360,8 @@ namespace DiscordBot
         {
             case RESUME:
             {
+                m_Socket.stop();
+                m_ReconnectPending = false;
                 m_Socket.start();
             }break;
         }
@@ -379,12 +397,30 @@ namespace DiscordBot
             case ix::WebSocketMessageType::Error:
             {
                 llog << lerror << "Websocket error " << msg->errorInfo.reason << lendl;
+                ScheduleReconnect();
             }break;
 
             case ix::WebSocketMessageType::Close:
             {
                 m_Terminate = true;
+                m_Timer->Cancel(m_HeartbeatTimer);
                 llog << linfo << "Websocket closed code " <<  msg->closeInfo.code << " Reason " <<  msg->closeInfo.reason << lendl;
+
+                switch (msg->closeInfo.code)
+                {
+                    //The voice session is gone, the bot must join the channel again.
+                    case 4004:  //Authentication failed
+                    case 4006:  //Session no longer valid
+                    case 4009:  //Session timeout
+                    case 4011:  //Server not found
+                    case 4014:  //Disconnected
+                        break;
+
+                    default:
+                    {
+                        ScheduleReconnect();
+                    }break;
+                }
             }break;
         
             case ix::WebSocketMessageType::Message:
@@ -420,6 +456,7 @@ namespace DiscordBot
                         try
                         {
                             json.ParseObject(Pay.D);
+                            m_Backoff.Reset();
 
                             m_SSRC = json.GetValue<int>("ssrc");
 
@@ -500,6 +537,7 @@ namespace DiscordBot
 
                     case OPCodes::RESUMED:
                     {
+                        m_Backoff.Reset();
                         llog << linfo << "Voice resumed" << lendl;
                     }break;
 
@@ -535,10 +573,8 @@ namespace DiscordBot
                         m_HeartACKReceived = true;
                         m_Terminate = false;
 
-                        if(m_Heartbeat.joinable())
-                            m_Heartbeat.join();
-
-                        m_Heartbeat = std::thread(&CVoiceSocket::Heartbeat, this);
+                        m_Timer->Cancel(m_HeartbeatTimer);
+                        m_HeartbeatTimer = m_Timer->Schedule(0, std::bind(&CVoiceSocket::Heartbeat, this), m_HeartbeatInterval);
                     }break;
 
                     case OPCodes::HEARTBEAT_ACK:
@@ -555,35 +591,41 @@ namespace DiscordBot
      */
     void CVoiceSocket::Heartbeat()
     {
-        while (!m_Terminate)
+        if(m_Terminate)
+            return;
+
+        //Start a reconnect. The socket is restarted by the message handler, because closing blocks the timer thread.
+        if(!m_HeartACKReceived)
         {
-            //Start a reconnect.
-            if(!m_HeartACKReceived)
-            {
-                m_Reconnect = true;
-                m_Socket.stop();
-                m_Terminate = true;
+            m_Terminate = true;
+            m_Timer->Cancel(m_HeartbeatTimer);
 
-                m_EVManager.PostMessage(RESUME, 0, 100);
-                break;
-            }
+            ScheduleReconnect();
+            return;
+        }
 
-            SendOP(OPCodes::HEARTBEAT, "5");
-            m_HeartACKReceived = false;
+        SendOP(OPCodes::HEARTBEAT, "5");
+        m_HeartACKReceived = false;
+    }
 
-            //Terminateable timeout.
-            int64_t Beg = GetTimeMillis();
-            while (((GetTimeMillis() - Beg) < m_HeartbeatInterval) && !m_Terminate)
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        }
+    /**
+     * @brief Resumes the voice session after a jittered backoff delay.
+     */
+    void CVoiceSocket::ScheduleReconnect()
+    {
+        if(m_ReconnectPending.exchange(true))
+            return;
+
+        m_Reconnect = true;
+        m_EVManager.PostMessage(RESUME, 0, m_Backoff.Next(true));
     }
 
     CVoiceSocket::~CVoiceSocket()
     {
         StopSpeaking();
+        m_ReconnectPending = true;
         m_Terminate = true;
-        if(m_Heartbeat.joinable())
-            m_Heartbeat.join();
+        m_Timer->Cancel(m_HeartbeatTimer);
 
         m_UDPSocket.close();
         m_Socket.stop();
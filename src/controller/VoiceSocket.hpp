@@ -32,6 +32,8 @@
 #include <ixwebsocket/IXUdpSocket.h>
 #include <atomic>
 #include "MessageManager.hpp"
+#include "TimerService.hpp"
+#include "ReconnectBackoff.hpp"
 
 namespace DiscordBot
 {    
@@ -64,8 +66,10 @@ namespace DiscordBot
              * @param json: JSON from VOICE_SERVER_UPDATE event,
              * @param SessionID: Session ID of the bot voice state.
              * @param ClientID: Bot client ID.
+             * @param Timer: Timer for the heartbeat.
+             * @param Executor: Shared pool for the reconnect messages. Without a pool the socket uses its own thread.
              */
-            CVoiceSocket(CJSON &json, const std::string &SessionID, const std::string &ClientID);
+            CVoiceSocket(CJSON &json, const std::string &SessionID, const std::string &ClientID, TimerService Timer, WorkerPool Executor = nullptr);
 
             /**
              * @brief Sets the callback which is called if the audio source finished.
@@ -97,6 +101,13 @@ namespace DiscordBot
              */
             void StopSpeaking();
 
+            /**
+             * @brief Stops the sending of audio without a OnSpeakFinish event. Used to continue the audio on a new connection.
+             * 
+             * @return Returns the audio source which was playing or null.
+             */
+            AudioSource DetachSource();
+
             /**
              * @return Gets the current playing audio source or null.
              */
@@ -119,6 +130,7 @@ namespace DiscordBot
                 RESUME
             };
 
+            TimerService m_Timer;
             CMessageManager m_EVManager;
             OnStopSpeaking m_Callback;
 
@@ -127,7 +139,7 @@ namespace DiscordBot
             std::string m_GuildID;
             ix::WebSocket m_Socket;
             ix::UdpSocket m_UDPSocket;
-            std::thread m_Heartbeat;
+            std::atomic<TimerID> m_HeartbeatTimer;
             std::atomic<bool> m_Terminate;
             std::atomic<bool> m_HeartACKReceived;
             uint32_t m_HeartbeatInterval;
@@ -138,6 +150,8 @@ namespace DiscordBot
             std::atomic<bool> m_Stop;
             std::atomic<bool> m_Pause;
             std::atomic<bool> m_Reconnect;
+            std::atomic<bool> m_ReconnectPending;
+            CReconnectBackoff m_Backoff;
             std::thread m_Playback;
 
             std::vector<uint8_t> m_SecKey;
@@ -160,10 +174,15 @@ namespace DiscordBot
             void OnWebsocketEvent(const ix::WebSocketMessagePtr& msg);
 
             /**
-             * @brief Sends a heartbeat.
+             * @brief Sends a heartbeat. Called by the timer service.
              */
             void Heartbeat();
 
+            /**
+             * @brief Restarts the socket after a backoff delay. Does nothing if a reconnect is already pending.
+             */
+            void ScheduleReconnect();
+
             /**
              * @brief Encode, encrypt and send audio data.
              */
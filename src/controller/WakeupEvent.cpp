@@ -0,0 +1,118 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "WakeupEvent.hpp"
+#include <config.h>
+#include <chrono>
+
+#ifndef DISCORDBOT_WINDOWS
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+namespace DiscordBot
+{
+    CWakeupEvent::CWakeupEvent() : m_Signaled(false), m_ReadFD(-1), m_WriteFD(-1)
+    {
+#if defined(__linux__)
+        m_ReadFD = m_WriteFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#elif !defined(DISCORDBOT_WINDOWS)
+        int FDs[2];
+        if(pipe(FDs) == 0)
+        {
+            fcntl(FDs[0], F_SETFL, O_NONBLOCK);
+            fcntl(FDs[1], F_SETFL, O_NONBLOCK);
+            m_ReadFD = FDs[0];
+            m_WriteFD = FDs[1];
+        }
+#endif
+    }
+
+    void CWakeupEvent::Signal()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Lock);
+
+            //The fd is written once per signal cycle.
+            if(m_Signaled)
+                return;
+
+            m_Signaled = true;
+
+#ifndef DISCORDBOT_WINDOWS
+            if(m_WriteFD != -1)
+            {
+                uint64_t Value = 1;
+                ssize_t Ret = write(m_WriteFD, &Value, sizeof(Value));
+                (void)Ret;
+            }
+#endif
+        }
+
+        m_Signal.notify_all();
+    }
+
+    bool CWakeupEvent::Wait(int32_t Timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_Lock);
+        if(Timeout < 0)
+            m_Signal.wait(lock, [this]() { return m_Signaled; });
+        else
+            m_Signal.wait_for(lock, std::chrono::milliseconds(Timeout), [this]() { return m_Signaled; });
+
+        return m_Signaled;
+    }
+
+    void CWakeupEvent::Clear()
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        if(!m_Signaled)
+            return;
+
+        m_Signaled = false;
+
+#ifndef DISCORDBOT_WINDOWS
+        if(m_ReadFD != -1)
+        {
+            uint64_t Value;
+            while (read(m_ReadFD, &Value, sizeof(Value)) > 0);
+        }
+#endif
+    }
+
+    CWakeupEvent::~CWakeupEvent()
+    {
+#ifndef DISCORDBOT_WINDOWS
+        if(m_ReadFD != -1)
+            close(m_ReadFD);
+
+        if(m_WriteFD != -1 && m_WriteFD != m_ReadFD)
+            close(m_WriteFD);
+#endif
+    }
+} // namespace DiscordBot
@@ -0,0 +1,84 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef WAKEUPEVENT_HPP
+#define WAKEUPEVENT_HPP
+
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+
+namespace DiscordBot
+{
+    /**
+     * @brief Wakes up a waiting thread or an external event loop.
+     * 
+     * On linux the event is backed by an eventfd, on other posix systems by a pipe. The fd is readable while the event is signaled.
+     * Windows has no pollable handle, there the event can only be waited with Wait().
+     */
+    class CWakeupEvent
+    {
+        public:
+            CWakeupEvent();
+
+            /**
+             * @brief Signals the event. Multiple signals are merged until the next Clear().
+             */
+            void Signal();
+
+            /**
+             * @brief Waits until the event is signaled.
+             * 
+             * @param Timeout: Timeout in milliseconds. A negative timeout waits forever.
+             * 
+             * @return Returns true if the event is signaled.
+             */
+            bool Wait(int32_t Timeout);
+
+            /**
+             * @brief Resets the event and drains the fd.
+             */
+            void Clear();
+
+            /**
+             * @return Returns the pollable fd or -1 if the platform has none.
+             */
+            int GetFD() const
+            {
+                return m_ReadFD;
+            }
+
+            ~CWakeupEvent();
+
+        private:
+            std::mutex m_Lock;
+            std::condition_variable m_Signal;
+            bool m_Signaled;
+            int m_ReadFD;
+            int m_WriteFD;
+    };
+} // namespace DiscordBot
+
+
+#endif //WAKEUPEVENT_HPP
@@ -0,0 +1,195 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "WorkerPool.hpp"
+#include <Log.hpp>
+#include <exception>
+
+namespace DiscordBot
+{
+    CWorkerPool::CWorkerPool(uint32_t Count, QueuedCallback OnQueued) : m_Terminate(false), m_OnQueued(OnQueued)
+    {
+        for (uint32_t i = 0; i < Count; i++)
+        {
+            m_Workers.emplace_back(new SWorker());
+            m_Workers.back()->Thread = std::thread(&CWorkerPool::Executor, this, m_Workers.back().get());
+        }
+    }
+
+    void CWorkerPool::Post(const std::string &Key, Task task)
+    {
+        if(m_Workers.empty())
+        {
+            if(m_OnQueued)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_HostLock);
+                    if(m_Terminate)
+                        return;
+
+                    m_HostTasks.push_back(std::move(task));
+                }
+
+                m_OnQueued();
+            }
+            else
+                Execute(task);
+
+            return;
+        }
+
+        SWorker *Worker = m_Workers[std::hash<std::string>()(Key) % m_Workers.size()].get();
+
+        {
+            std::lock_guard<std::mutex> lock(Worker->Lock);
+            Worker->Tasks.push_back(std::move(task));
+        }
+
+        Worker->Signal.notify_one();
+    }
+
+    bool CWorkerPool::IsWorkerThread() const
+    {
+        for (auto &&e : m_Workers)
+        {
+            if(e->Thread.get_id() == std::this_thread::get_id())
+                return true;
+        }
+
+        return false;
+    }
+
+    void CWorkerPool::Wait()
+    {
+        //The host executes the tasks itself.
+        while (RunPending() != 0);
+
+        for (auto &&e : m_Workers)
+        {
+            std::unique_lock<std::mutex> lock(e->Lock);
+            e->Idle.wait(lock, [this, &e]()
+            {
+                return m_Terminate || (e->Tasks.empty() && !e->Busy);
+            });
+        }
+    }
+
+    size_t CWorkerPool::RunPending()
+    {
+        std::deque<Task> Tasks;
+        {
+            std::lock_guard<std::mutex> lock(m_HostLock);
+            Tasks.swap(m_HostTasks);
+        }
+
+        size_t Count = 0;
+        for (auto &&e : Tasks)
+        {
+            //A task could stop the pool.
+            if(m_Terminate)
+                break;
+
+            Execute(e);
+            Count++;
+        }
+
+        return Count;
+    }
+
+    void CWorkerPool::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_HostLock);
+            m_Terminate = true;
+            m_HostTasks.clear();
+        }
+
+        for (auto &&e : m_Workers)
+        {
+            {
+                std::lock_guard<std::mutex> lock(e->Lock);
+                e->Tasks.clear();
+            }
+
+            e->Signal.notify_all();
+            e->Idle.notify_all();
+        }
+
+        //A task could stop the pool.
+        for (auto &&e : m_Workers)
+        {
+            if(e->Thread.joinable() && e->Thread.get_id() != std::this_thread::get_id())
+                e->Thread.join();
+        }
+    }
+
+    void CWorkerPool::Executor(SWorker *Worker)
+    {
+        std::unique_lock<std::mutex> lock(Worker->Lock);
+        while (!m_Terminate)
+        {
+            if(Worker->Tasks.empty())
+            {
+                Worker->Signal.wait(lock);
+                continue;
+            }
+
+            Task task = std::move(Worker->Tasks.front());
+            Worker->Tasks.pop_front();
+            Worker->Busy = true;
+
+            lock.unlock();
+            Execute(task);
+            lock.lock();
+
+            Worker->Busy = false;
+            if(Worker->Tasks.empty())
+                Worker->Idle.notify_all();
+        }
+    }
+
+    void CWorkerPool::Execute(const Task &task)
+    {
+        try
+        {
+            task();
+        }
+        catch (const std::exception &e)
+        {
+            llog << lerror << "Unhandled exception in event handler what(): " << e.what() << lendl;
+        }
+    }
+
+    CWorkerPool::~CWorkerPool()
+    {
+        Stop();
+
+        //Detaches the thread which destroys the pool inside a task.
+        for (auto &&e : m_Workers)
+        {
+            if(e->Thread.joinable())
+                e->Thread.detach();
+        }
+    }
+} // namespace DiscordBot
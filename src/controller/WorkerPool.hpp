@@ -0,0 +1,130 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef WORKERPOOL_HPP
+#define WORKERPOOL_HPP
+
+#include <functional>
+#include <deque>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+
+namespace DiscordBot
+{
+    /**
+     * @brief Executes tasks on a fixed count of threads. Tasks with the same key are executed in order on the same worker, different keys run in parallel.
+     */
+    class CWorkerPool
+    {
+        public:
+            using Task = std::function<void()>;
+            using QueuedCallback = std::function<void()>;
+
+            /**
+             * @param Count: Count of worker threads. With 0 workers the tasks are executed inline by Post(), unless a queued callback is set.
+             * @param OnQueued: Only used without workers. Tasks are queued for the host, which is notified by this callback and executes them with RunPending().
+             */
+            CWorkerPool(uint32_t Count, QueuedCallback OnQueued = nullptr);
+
+            /**
+             * @brief Queues a task on the worker of the key.
+             * 
+             * @param Key: Ordering key e.g. the guild id.
+             * @param task: Task to execute.
+             */
+            void Post(const std::string &Key, Task task);
+
+            /**
+             * @return Returns the count of worker threads.
+             */
+            uint32_t GetWorkerCount() const
+            {
+                return (uint32_t)m_Workers.size();
+            }
+
+            /**
+             * @return Returns true if the calling thread is a worker of this pool.
+             */
+            bool IsWorkerThread() const;
+
+            /**
+             * @brief Blocks until all queued tasks are executed.
+             * 
+             * @note Must not be called from a task.
+             */
+            void Wait();
+
+            /**
+             * @brief Executes all tasks which are queued for the host on the calling thread.
+             * 
+             * @return Returns the count of executed tasks.
+             */
+            size_t RunPending();
+
+            /**
+             * @brief Stops all workers. Pending tasks are dropped.
+             */
+            void Stop();
+
+            ~CWorkerPool();
+
+        private:
+            struct SWorker
+            {
+                SWorker() : Busy(false) {}
+
+                std::mutex Lock;
+                std::condition_variable Signal;
+                std::condition_variable Idle;
+                std::deque<Task> Tasks;
+                std::thread Thread;
+                bool Busy;
+            };
+
+            std::vector<std::unique_ptr<SWorker>> m_Workers;
+            std::atomic<bool> m_Terminate;
+
+            QueuedCallback m_OnQueued;
+            std::mutex m_HostLock;
+            std::deque<Task> m_HostTasks;   //!< Tasks for the host, if the pool has no workers.
+
+            void Executor(SWorker *Worker);
+
+            /**
+             * @brief Runs a task and logs escaped exceptions, so one failing event doesn't kill the worker.
+             */
+            static void Execute(const Task &task);
+    };
+
+    using WorkerPool = std::shared_ptr<CWorkerPool>;
+} // namespace DiscordBot
+
+
+#endif //WORKERPOOL_HPP
@@ -0,0 +1,907 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ETF.hpp"
+#include "../models/Payload.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits>
+
+namespace DiscordBot
+{
+    const size_t CETFDecoder::MAX_DEPTH;
+    const size_t CETFEncoder::MAX_DEPTH;
+
+    //--------------------------Decoder--------------------------//
+
+    bool CETFDecoder::Decode(const std::string &Data, SEnvelope &Env, std::string &JSON)
+    {
+        JSON.clear();
+
+        m_Beg = (const uint8_t*)Data.data();
+        m_End = m_Beg + Data.size();
+        m_Depth = 0;
+        m_Snowflake = false;
+
+        if(!Has(6) || *m_Beg != (uint8_t)ETFTag::FORMAT_VERSION || m_Beg[1] != (uint8_t)ETFTag::MAP_EXT)
+            return false;
+
+        m_Beg += 2;
+        uint32_t Arity = ReadU32();
+        bool HasOP = false;
+
+        std::string Key, Value;
+        for (uint32_t i = 0; i < Arity; i++)
+        {
+            Key.clear();
+            m_Out = &Key;
+            if(!ReadKey())
+                return false;
+
+            if(Key == "\"d\"")
+            {
+                m_Out = &JSON;
+                if(!ReadTerm())
+                    return false;
+
+                Env.D.Pos = 0;
+                Env.D.Len = JSON.size();
+                continue;
+            }
+
+            if(!ReadTerm(Value))
+                return false;
+
+            if(Key == "\"op\"")
+            {
+                Env.OP = (uint32_t)strtoul(Value.c_str(), nullptr, 10);
+                HasOP = true;
+            }
+            else if(Key == "\"s\"")
+                Env.S = (uint32_t)strtoul(Value.c_str(), nullptr, 10);
+            else if(Key == "\"t\"")
+                Env.T = Value.size() >= 2 && Value.front() == '"' ? Value.substr(1, Value.size() - 2) : "";
+        }
+
+        return HasOP;
+    }
+
+    bool CETFDecoder::ReadTerm(std::string &Out)
+    {
+        Out.clear();
+
+        std::string *Tmp = m_Out;
+        m_Out = &Out;
+
+        bool Ret = ReadTerm();
+        m_Out = Tmp;
+
+        return Ret;
+    }
+
+    bool CETFDecoder::ReadTerm()
+    {
+        if(!Has(1) || m_Depth > MAX_DEPTH)
+            return false;
+
+        ETFTag Tag = (ETFTag)*m_Beg++;
+        switch (Tag)
+        {
+            case ETFTag::SMALL_INTEGER_EXT:
+            {
+                if(!Has(1))
+                    return false;
+
+                m_Out->append(std::to_string(*m_Beg++));
+            }break;
+
+            case ETFTag::INTEGER_EXT:
+            {
+                if(!Has(4))
+                    return false;
+
+                m_Out->append(std::to_string((int32_t)ReadU32()));
+            }break;
+
+            case ETFTag::NEW_FLOAT_EXT:
+            {
+                if(!Has(8))
+                    return false;
+
+                uint64_t Bits = 0;
+                for (size_t i = 0; i < 8; i++)
+                    Bits = (Bits << 8) | *m_Beg++;
+
+                double Val;
+                memcpy(&Val, &Bits, sizeof(Val));
+
+                char Buf[32];
+                snprintf(Buf, sizeof(Buf), "%.17g", Val);
+                m_Out->append(Buf);
+            }break;
+
+            case ETFTag::FLOAT_EXT:
+            {
+                if(!Has(31))
+                    return false;
+
+                //Null terminated float string.
+                m_Out->append((const char*)m_Beg, strnlen((const char*)m_Beg, 31));
+                m_Beg += 31;
+            }break;
+
+            case ETFTag::ATOM_EXT:
+            case ETFTag::ATOM_UTF8_EXT:
+            {
+                if(!Has(2))
+                    return false;
+
+                return ReadAtom(ReadU16());
+            }break;
+
+            case ETFTag::SMALL_ATOM_EXT:
+            case ETFTag::SMALL_ATOM_UTF8_EXT:
+            {
+                if(!Has(1))
+                    return false;
+
+                return ReadAtom(*m_Beg++);
+            }break;
+
+            case ETFTag::BINARY_EXT:
+            {
+                if(!Has(4))
+                    return false;
+
+                uint32_t Len = ReadU32();
+                if(!Has(Len))
+                    return false;
+
+                WriteString((const char*)m_Beg, Len);
+                m_Beg += Len;
+            }break;
+
+            case ETFTag::SMALL_BIG_EXT:
+            {
+                if(!Has(1))
+                    return false;
+
+                return ReadBig(*m_Beg++);
+            }break;
+
+            case ETFTag::LARGE_BIG_EXT:
+            {
+                if(!Has(4))
+                    return false;
+
+                return ReadBig(ReadU32());
+            }break;
+
+            case ETFTag::NIL_EXT:
+            {
+                m_Out->append("[]");
+            }break;
+
+            //A list of bytes. Erlang encodes lists of small integers this way.
+            case ETFTag::STRING_EXT:
+            {
+                if(!Has(2))
+                    return false;
+
+                uint16_t Len = ReadU16();
+                if(!Has(Len))
+                    return false;
+
+                m_Out->push_back('[');
+                for (uint16_t i = 0; i < Len; i++)
+                {
+                    if(i != 0)
+                        m_Out->push_back(',');
+
+                    m_Out->append(std::to_string(*m_Beg++));
+                }
+                m_Out->push_back(']');
+            }break;
+
+            case ETFTag::LIST_EXT:
+            {
+                if(!Has(4))
+                    return false;
+
+                return ReadList(ReadU32(), true);
+            }break;
+
+            case ETFTag::SMALL_TUPLE_EXT:
+            {
+                if(!Has(1))
+                    return false;
+
+                return ReadList(*m_Beg++, false);
+            }break;
+
+            case ETFTag::LARGE_TUPLE_EXT:
+            {
+                if(!Has(4))
+                    return false;
+
+                return ReadList(ReadU32(), false);
+            }break;
+
+            case ETFTag::MAP_EXT:
+            {
+                if(!Has(4))
+                    return false;
+
+                return ReadMap(ReadU32());
+            }break;
+
+            default:
+                return false;
+        }
+
+        return true;
+    }
+
+    bool CETFDecoder::ReadAtom(size_t Len)
+    {
+        if(!Has(Len))
+            return false;
+
+        const char *Atom = (const char*)m_Beg;
+        m_Beg += Len;
+
+        if((Len == 3 && memcmp(Atom, "nil", 3) == 0) || (Len == 4 && memcmp(Atom, "null", 4) == 0))
+            m_Out->append("null");
+        else if(Len == 4 && memcmp(Atom, "true", 4) == 0)
+            m_Out->append("true");
+        else if(Len == 5 && memcmp(Atom, "false", 5) == 0)
+            m_Out->append("false");
+        else
+            WriteString(Atom, Len);
+
+        return true;
+    }
+
+    bool CETFDecoder::ReadBig(size_t Len)
+    {
+        //Sign byte + digits.
+        if(!Has(Len + 1) || Len > sizeof(uint64_t))
+            return false;
+
+        bool Negative = *m_Beg++ != 0;
+        uint64_t Val = 0;
+
+        //Little endian digits.
+        for (size_t i = 0; i < Len; i++)
+            Val |= ((uint64_t)m_Beg[i]) << (8 * i);
+
+        m_Beg += Len;
+
+        //The json gateway sends snowflakes as strings. Other values, like timestamps in milliseconds, are numbers.
+        if(m_Snowflake)
+            m_Out->push_back('"');
+
+        if(Negative)
+            m_Out->push_back('-');
+
+        m_Out->append(std::to_string(Val));
+
+        if(m_Snowflake)
+            m_Out->push_back('"');
+
+        return true;
+    }
+
+    bool CETFDecoder::ReadList(uint32_t Count, bool HasTail)
+    {
+        m_Depth++;
+        m_Out->push_back('[');
+
+        for (uint32_t i = 0; i < Count; i++)
+        {
+            if(i != 0)
+                m_Out->push_back(',');
+
+            if(!ReadTerm())
+                return false;
+        }
+
+        m_Out->push_back(']');
+
+        //Proper lists ends with an empty list.
+        if(HasTail)
+        {
+            if(!Has(1))
+                return false;
+
+            if(*m_Beg == (uint8_t)ETFTag::NIL_EXT)
+                m_Beg++;
+            else
+            {
+                //Improper lists are not used by discord, skip the tail.
+                std::string *Out = m_Out;
+                std::string Tail;
+                m_Out = &Tail;
+
+                bool Ret = ReadTerm();
+                m_Out = Out;
+
+                if(!Ret)
+                    return false;
+            }
+        }
+
+        m_Depth--;
+        return true;
+    }
+
+    bool CETFDecoder::ReadMap(uint32_t Arity)
+    {
+        m_Depth++;
+        m_Out->push_back('{');
+
+        for (uint32_t i = 0; i < Arity; i++)
+        {
+            if(i != 0)
+                m_Out->push_back(',');
+
+            size_t KeyPos = m_Out->size();
+            if(!ReadKey())
+                return false;
+
+            //The key is written with quotes.
+            bool Snowflake = m_Snowflake;
+            m_Snowflake = IsSnowflakeKey(m_Out->data() + KeyPos + 1, m_Out->size() - KeyPos - 2);
+
+            m_Out->push_back(':');
+            bool Ret = ReadTerm();
+            m_Snowflake = Snowflake;
+
+            if(!Ret)
+                return false;
+        }
+
+        m_Out->push_back('}');
+        m_Depth--;
+
+        return true;
+    }
+
+    bool CETFDecoder::IsSnowflakeKey(const char *Key, size_t Len)
+    {
+        auto EndsWith = [Key, Len](const char *Suffix)
+        {
+            size_t SuffixLen = strlen(Suffix);
+            return Len >= SuffixLen && memcmp(Key + Len - SuffixLen, Suffix, SuffixLen) == 0;
+        };
+
+        //"id", "guild_id", "member_ids" and the role lists.
+        return (Len == 2 && memcmp(Key, "id", 2) == 0) || EndsWith("_id") || EndsWith("_ids") || EndsWith("roles");
+    }
+
+    bool CETFDecoder::ReadKey()
+    {
+        if(!Has(1))
+            return false;
+
+        //Json keys must be strings.
+        ETFTag Tag = (ETFTag)*m_Beg;
+        switch (Tag)
+        {
+            case ETFTag::BINARY_EXT:
+            {
+                return ReadTerm();
+            }break;
+
+            //Json keys must be strings.
+            case ETFTag::SMALL_BIG_EXT:
+            case ETFTag::LARGE_BIG_EXT:
+            {
+                bool Snowflake = m_Snowflake;
+                m_Snowflake = true;
+
+                bool Ret = ReadTerm();
+                m_Snowflake = Snowflake;
+
+                return Ret;
+            }break;
+
+            case ETFTag::ATOM_EXT:
+            case ETFTag::ATOM_UTF8_EXT:
+            {
+                m_Beg++;
+                if(!Has(2))
+                    return false;
+
+                uint16_t Len = ReadU16();
+                if(!Has(Len))
+                    return false;
+
+                WriteString((const char*)m_Beg, Len);
+                m_Beg += Len;
+            }break;
+
+            case ETFTag::SMALL_ATOM_EXT:
+            case ETFTag::SMALL_ATOM_UTF8_EXT:
+            {
+                m_Beg++;
+                if(!Has(1))
+                    return false;
+
+                uint8_t Len = *m_Beg++;
+                if(!Has(Len))
+                    return false;
+
+                WriteString((const char*)m_Beg, Len);
+                m_Beg += Len;
+            }break;
+
+            default:
+            {
+                std::string *Out = m_Out;
+                std::string Key;
+                m_Out = &Key;
+
+                bool Ret = ReadTerm();
+                m_Out = Out;
+
+                if(!Ret)
+                    return false;
+
+                WriteString(Key.data(), Key.size());
+            }break;
+        }
+
+        return true;
+    }
+
+    void CETFDecoder::WriteString(const char *Str, size_t Len)
+    {
+        static const char HEX[] = "0123456789abcdef";
+
+        m_Out->push_back('"');
+
+        const char *End = Str + Len;
+        const char *Beg = Str;
+
+        //Copies unescaped ranges at once.
+        while (Str != End)
+        {
+            unsigned char c = (unsigned char)*Str;
+            if(c == '"' || c == '\\' || c < 0x20)
+            {
+                m_Out->append(Beg, Str - Beg);
+                m_Out->push_back('\\');
+
+                switch (c)
+                {
+                    case '"': m_Out->push_back('"'); break;
+                    case '\\': m_Out->push_back('\\'); break;
+                    case '\n': m_Out->push_back('n'); break;
+                    case '\r': m_Out->push_back('r'); break;
+                    case '\t': m_Out->push_back('t'); break;
+                    case '\b': m_Out->push_back('b'); break;
+                    case '\f': m_Out->push_back('f'); break;
+                    default:
+                    {
+                        m_Out->append("u00");
+                        m_Out->push_back(HEX[c >> 4]);
+                        m_Out->push_back(HEX[c & 0xF]);
+                    }break;
+                }
+
+                Beg = Str + 1;
+            }
+
+            Str++;
+        }
+
+        m_Out->append(Beg, End - Beg);
+        m_Out->push_back('"');
+    }
+
+    uint16_t CETFDecoder::ReadU16()
+    {
+        uint16_t Ret = (uint16_t)((m_Beg[0] << 8) | m_Beg[1]);
+        m_Beg += 2;
+
+        return Ret;
+    }
+
+    uint32_t CETFDecoder::ReadU32()
+    {
+        uint32_t Ret = ((uint32_t)m_Beg[0] << 24) | ((uint32_t)m_Beg[1] << 16) | ((uint32_t)m_Beg[2] << 8) | (uint32_t)m_Beg[3];
+        m_Beg += 4;
+
+        return Ret;
+    }
+
+    //--------------------------Encoder--------------------------//
+
+    bool CETFEncoder::Encode(uint32_t OP, const std::string &D, std::string &Data)
+    {
+        Data.clear();
+        Data.push_back((char)ETFTag::FORMAT_VERSION);
+
+        m_Out = &Data;
+        m_Depth = 0;
+
+        m_Out->push_back((char)ETFTag::MAP_EXT);
+        WriteU32(2);
+
+        WriteBinary("op");
+        m_Out->push_back((char)ETFTag::INTEGER_EXT);
+        WriteU32(OP);
+
+        WriteBinary("d");
+        if(D.empty())
+        {
+            WriteAtom("nil");
+            return true;
+        }
+
+        m_Beg = D.data();
+        m_End = m_Beg + D.size();
+
+        if(!WriteValue())
+            return false;
+
+        SkipWhitespaces();
+        return m_Beg == m_End;
+    }
+
+    bool CETFEncoder::WriteValue()
+    {
+        SkipWhitespaces();
+        if(m_Beg == m_End || m_Depth > MAX_DEPTH)
+            return false;
+
+        switch (*m_Beg)
+        {
+            case '{': return WriteObject();
+            case '[': return WriteArray();
+            case 't': return WriteLiteral("true", "true");
+            case 'f': return WriteLiteral("false", "false");
+            case 'n': return WriteLiteral("null", "nil");
+            case '"':
+            {
+                std::string Str;
+                if(!ReadString(Str))
+                    return false;
+
+                WriteBinary(Str);
+                return true;
+            }
+
+            default: return WriteNumber();
+        }
+    }
+
+    bool CETFEncoder::WriteObject()
+    {
+        m_Depth++;
+        m_Beg++;    // {
+
+        m_Out->push_back((char)ETFTag::MAP_EXT);
+        size_t ArityPos = m_Out->size();
+        WriteU32(0);
+
+        uint32_t Arity = 0;
+
+        SkipWhitespaces();
+        if(m_Beg != m_End && *m_Beg == '}')
+            m_Beg++;
+        else
+        {
+            while (true)
+            {
+                SkipWhitespaces();
+
+                std::string Key;
+                if(m_Beg == m_End || *m_Beg != '"' || !ReadString(Key))
+                    return false;
+
+                WriteBinary(Key);
+
+                SkipWhitespaces();
+                if(m_Beg == m_End || *m_Beg != ':')
+                    return false;
+
+                m_Beg++;
+                if(!WriteValue())
+                    return false;
+
+                Arity++;
+
+                SkipWhitespaces();
+                if(m_Beg == m_End)
+                    return false;
+                else if(*m_Beg == ',')
+                    m_Beg++;
+                else if(*m_Beg == '}')
+                {
+                    m_Beg++;
+                    break;
+                }
+                else
+                    return false;
+            }
+        }
+
+        PatchU32(ArityPos, Arity);
+        m_Depth--;
+
+        return true;
+    }
+
+    bool CETFEncoder::WriteArray()
+    {
+        m_Depth++;
+        m_Beg++;    // [
+
+        SkipWhitespaces();
+        if(m_Beg != m_End && *m_Beg == ']')
+        {
+            m_Beg++;
+            m_Out->push_back((char)ETFTag::NIL_EXT);
+            m_Depth--;
+
+            return true;
+        }
+
+        m_Out->push_back((char)ETFTag::LIST_EXT);
+        size_t CountPos = m_Out->size();
+        WriteU32(0);
+
+        uint32_t Count = 0;
+        while (true)
+        {
+            if(!WriteValue())
+                return false;
+
+            Count++;
+
+            SkipWhitespaces();
+            if(m_Beg == m_End)
+                return false;
+            else if(*m_Beg == ',')
+                m_Beg++;
+            else if(*m_Beg == ']')
+            {
+                m_Beg++;
+                break;
+            }
+            else
+                return false;
+        }
+
+        //Proper list tail.
+        m_Out->push_back((char)ETFTag::NIL_EXT);
+        PatchU32(CountPos, Count);
+        m_Depth--;
+
+        return true;
+    }
+
+    bool CETFEncoder::WriteNumber()
+    {
+        const char *Beg = m_Beg;
+        bool IsFloat = false;
+
+        if(m_Beg != m_End && *m_Beg == '-')
+            m_Beg++;
+
+        while (m_Beg != m_End)
+        {
+            char c = *m_Beg;
+            if(c == '.' || c == 'e' || c == 'E' || c == '+' || (c == '-' && m_Beg != Beg))
+                IsFloat = true;
+            else if(!isdigit((unsigned char)c))
+                break;
+
+            m_Beg++;
+        }
+
+        std::string Num(Beg, m_Beg - Beg);
+        if(Num.empty() || Num == "-")
+            return false;
+
+        if(IsFloat)
+        {
+            double Val = strtod(Num.c_str(), nullptr);
+            uint64_t Bits;
+            memcpy(&Bits, &Val, sizeof(Bits));
+
+            m_Out->push_back((char)ETFTag::NEW_FLOAT_EXT);
+            for (int i = 7; i >= 0; i--)
+                m_Out->push_back((char)((Bits >> (i * 8)) & 0xFF));
+
+            return true;
+        }
+
+        bool Negative = Num[0] == '-';
+        uint64_t Val = strtoull(Num.c_str() + (Negative ? 1 : 0), nullptr, 10);
+
+        if(!Negative && Val <= 0xFF)
+        {
+            m_Out->push_back((char)ETFTag::SMALL_INTEGER_EXT);
+            m_Out->push_back((char)Val);
+        }
+        else if((!Negative && Val <= (uint64_t)std::numeric_limits<int32_t>::max()) || (Negative && Val <= (uint64_t)std::numeric_limits<int32_t>::max() + 1))
+        {
+            int32_t Int = Negative ? (int32_t)(0 - Val) : (int32_t)Val;
+
+            m_Out->push_back((char)ETFTag::INTEGER_EXT);
+            WriteU32((uint32_t)Int);
+        }
+        else
+        {
+            m_Out->push_back((char)ETFTag::SMALL_BIG_EXT);
+            size_t LenPos = m_Out->size();
+            m_Out->push_back(0);
+            m_Out->push_back(Negative ? 1 : 0);
+
+            uint8_t Len = 0;
+            while (Val)
+            {
+                m_Out->push_back((char)(Val & 0xFF));
+                Val >>= 8;
+                Len++;
+            }
+
+            (*m_Out)[LenPos] = (char)Len;
+        }
+
+        return true;
+    }
+
+    bool CETFEncoder::WriteLiteral(const char *Literal, const char *Atom)
+    {
+        size_t Len = strlen(Literal);
+        if((size_t)(m_End - m_Beg) < Len || memcmp(m_Beg, Literal, Len) != 0)
+            return false;
+
+        m_Beg += Len;
+        WriteAtom(Atom);
+
+        return true;
+    }
+
+    void CETFEncoder::WriteAtom(const char *Atom)
+    {
+        size_t Len = strlen(Atom);
+        m_Out->push_back((char)ETFTag::SMALL_ATOM_UTF8_EXT);
+        m_Out->push_back((char)Len);
+        m_Out->append(Atom, Len);
+    }
+
+    bool CETFEncoder::ReadString(std::string &Str)
+    {
+        m_Beg++;    // "
+
+        while (m_Beg != m_End && *m_Beg != '"')
+        {
+            if(*m_Beg != '\\')
+            {
+                Str.push_back(*m_Beg++);
+                continue;
+            }
+
+            m_Beg++;
+            if(m_Beg == m_End)
+                return false;
+
+            switch (*m_Beg)
+            {
+                case '"': Str.push_back('"'); break;
+                case '\\': Str.push_back('\\'); break;
+                case '/': Str.push_back('/'); break;
+                case 'b': Str.push_back('\b'); break;
+                case 'f': Str.push_back('\f'); break;
+                case 'n': Str.push_back('\n'); break;
+                case 'r': Str.push_back('\r'); break;
+                case 't': Str.push_back('\t'); break;
+                case 'u':
+                {
+                    if(m_End - m_Beg < 5)
+                        return false;
+
+                    uint32_t CodePoint = (uint32_t)strtoul(std::string(m_Beg + 1, 4).c_str(), nullptr, 16);
+                    m_Beg += 4;
+
+                    //Surrogate pair.
+                    if(CodePoint >= 0xD800 && CodePoint <= 0xDBFF && m_End - m_Beg >= 7 && m_Beg[1] == '\\' && m_Beg[2] == 'u')
+                    {
+                        uint32_t Low = (uint32_t)strtoul(std::string(m_Beg + 3, 4).c_str(), nullptr, 16);
+                        CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + (Low - 0xDC00);
+                        m_Beg += 6;
+                    }
+
+                    //UTF-8 encoding.
+                    if(CodePoint < 0x80)
+                        Str.push_back((char)CodePoint);
+                    else if(CodePoint < 0x800)
+                    {
+                        Str.push_back((char)(0xC0 | (CodePoint >> 6)));
+                        Str.push_back((char)(0x80 | (CodePoint & 0x3F)));
+                    }
+                    else if(CodePoint < 0x10000)
+                    {
+                        Str.push_back((char)(0xE0 | (CodePoint >> 12)));
+                        Str.push_back((char)(0x80 | ((CodePoint >> 6) & 0x3F)));
+                        Str.push_back((char)(0x80 | (CodePoint & 0x3F)));
+                    }
+                    else
+                    {
+                        Str.push_back((char)(0xF0 | (CodePoint >> 18)));
+                        Str.push_back((char)(0x80 | ((CodePoint >> 12) & 0x3F)));
+                        Str.push_back((char)(0x80 | ((CodePoint >> 6) & 0x3F)));
+                        Str.push_back((char)(0x80 | (CodePoint & 0x3F)));
+                    }
+                }break;
+
+                default:
+                    return false;
+            }
+
+            m_Beg++;
+        }
+
+        if(m_Beg == m_End)
+            return false;
+
+        m_Beg++;    // "
+        return true;
+    }
+
+    void CETFEncoder::SkipWhitespaces()
+    {
+        while (m_Beg != m_End && isspace((unsigned char)*m_Beg))
+            m_Beg++;
+    }
+
+    void CETFEncoder::WriteU32(uint32_t Val)
+    {
+        m_Out->push_back((char)((Val >> 24) & 0xFF));
+        m_Out->push_back((char)((Val >> 16) & 0xFF));
+        m_Out->push_back((char)((Val >> 8) & 0xFF));
+        m_Out->push_back((char)(Val & 0xFF));
+    }
+
+    void CETFEncoder::PatchU32(size_t Pos, uint32_t Val)
+    {
+        (*m_Out)[Pos] = (char)((Val >> 24) & 0xFF);
+        (*m_Out)[Pos + 1] = (char)((Val >> 16) & 0xFF);
+        (*m_Out)[Pos + 2] = (char)((Val >> 8) & 0xFF);
+        (*m_Out)[Pos + 3] = (char)(Val & 0xFF);
+    }
+
+    void CETFEncoder::WriteBinary(const std::string &Str)
+    {
+        m_Out->push_back((char)ETFTag::BINARY_EXT);
+        WriteU32((uint32_t)Str.size());
+        m_Out->append(Str);
+    }
+} // namespace DiscordBot
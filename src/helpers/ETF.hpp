@@ -0,0 +1,168 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ETF_HPP
+#define ETF_HPP
+
+#include <string>
+#include <stdint.h>
+
+namespace DiscordBot
+{
+    struct SEnvelope;
+
+    /**
+     * @brief Tags of the external term format. See http://erlang.org/doc/apps/erts/erl_ext_dist.html
+     */
+    enum class ETFTag : uint8_t
+    {
+        NEW_FLOAT_EXT       = 70,
+        SMALL_INTEGER_EXT   = 97,
+        INTEGER_EXT         = 98,
+        FLOAT_EXT           = 99,
+        ATOM_EXT            = 100,
+        SMALL_TUPLE_EXT     = 104,
+        LARGE_TUPLE_EXT     = 105,
+        NIL_EXT             = 106,
+        STRING_EXT          = 107,
+        LIST_EXT            = 108,
+        BINARY_EXT          = 109,
+        SMALL_BIG_EXT       = 110,
+        LARGE_BIG_EXT       = 111,
+        SMALL_ATOM_EXT      = 115,
+        MAP_EXT             = 116,
+        ATOM_UTF8_EXT       = 118,
+        SMALL_ATOM_UTF8_EXT = 119,
+
+        FORMAT_VERSION      = 131
+    };
+
+    /**
+     * @brief Decodes gateway messages in the erlang term format.
+     * 
+     * The envelope is decoded directly, only "d" is written as json, so it can be consumed by the same model builders as a json gateway message.
+     * Snowflakes are transferred as big integers and are written as json strings, like the json gateway does. Other big integers stay numbers.
+     */
+    class CETFDecoder
+    {
+        public:
+            CETFDecoder() : m_Beg(nullptr), m_End(nullptr), m_Out(nullptr), m_Depth(0), m_Snowflake(false) {}
+
+            /**
+             * @brief Decodes a gateway message.
+             * 
+             * @param Data: Binary etf message, beginning with the version byte.
+             * @param Env: Receives op, s and t. "d" references the json inside of JSON.
+             * @param JSON: Receives the json representation of "d". The buffer is cleared before it is written.
+             * 
+             * @return Returns false if the message is invalid.
+             */
+            bool Decode(const std::string &Data, SEnvelope &Env, std::string &JSON);
+
+        private:
+            static const size_t MAX_DEPTH = 256;
+
+            const uint8_t *m_Beg;
+            const uint8_t *m_End;
+            std::string *m_Out;
+            size_t m_Depth;
+            bool m_Snowflake;   //!< True if big integers of the current value are snowflakes.
+
+            /**
+             * @return Returns true if the value of the key contains snowflakes.
+             */
+            static bool IsSnowflakeKey(const char *Key, size_t Len);
+
+            /**
+             * @brief Reads a term into a temporary buffer.
+             */
+            bool ReadTerm(std::string &Out);
+
+            bool ReadTerm();
+            bool ReadAtom(size_t Len);
+            bool ReadBig(size_t Len);
+            bool ReadList(uint32_t Count, bool HasTail);
+            bool ReadMap(uint32_t Arity);
+            bool ReadKey();
+
+            void WriteString(const char *Str, size_t Len);
+
+            inline bool Has(size_t Len) const
+            {
+                return (size_t)(m_End - m_Beg) >= Len;
+            }
+
+            uint16_t ReadU16();
+            uint32_t ReadU32();
+    };
+
+    /**
+     * @brief Encodes gateway payloads to the erlang term format.
+     */
+    class CETFEncoder
+    {
+        public:
+            CETFEncoder() : m_Beg(nullptr), m_End(nullptr), m_Out(nullptr), m_Depth(0) {}
+
+            /**
+             * @brief Encodes a gateway payload. The envelope is written directly, only "d" is converted from json.
+             * 
+             * @param OP: Opcode of the payload.
+             * @param D: Json text of "d". An empty string is sent as nil.
+             * @param Data: Receives the etf message including the version byte.
+             * 
+             * @return Returns false if "d" is invalid.
+             */
+            bool Encode(uint32_t OP, const std::string &D, std::string &Data);
+
+        private:
+            static const size_t MAX_DEPTH = 256;
+
+            const char *m_Beg;
+            const char *m_End;
+            std::string *m_Out;
+            size_t m_Depth;
+
+            bool WriteValue();
+            bool WriteObject();
+            bool WriteArray();
+            bool WriteNumber();
+            bool WriteLiteral(const char *Literal, const char *Atom);
+
+            /**
+             * @brief Parses a json string and unescapes it.
+             */
+            bool ReadString(std::string &Str);
+
+            void SkipWhitespaces();
+
+            void WriteAtom(const char *Atom);
+            void WriteU32(uint32_t Val);
+            void PatchU32(size_t Pos, uint32_t Val);
+            void WriteBinary(const std::string &Str);
+    };
+} // namespace DiscordBot
+
+
+#endif //ETF_HPP
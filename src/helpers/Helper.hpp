@@ -63,6 +63,14 @@ namespace DiscordBot
         return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
     }
 
+    /**
+     * @return Gets a monotonic time in milliseconds, which is used to measure durations.
+     */
+    inline int64_t GetSteadyMillis()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
     inline bool IsLittleEndian()
     {
         short t = 1;
@@ -27,6 +27,8 @@
 
 #include <models/Embed.hpp>
 #include <models/User.hpp>
+#include <models/Guild.hpp>
+#include <models/VoiceState.hpp>
 #include <models/atomic.hpp>
 #include <map>
 #include <JSON.hpp>
@@ -178,6 +180,164 @@ namespace DiscordBot
         return js.Serialize();
     }
 
+    //--------------------------Cache snapshots--------------------------//
+    //The objects are written in the format of the gateway, so they can be read by the same code which handles the events.
+
+    /**
+     * @brief Joins serialized objects to a json array.
+     */
+    template<class T, class FN>
+    inline std::string SerializeArray(const T &Objs, FN f)
+    {
+        std::string Ret;
+        for (auto &&e : Objs)
+            Ret += (Ret.empty() ? "" : ",") + f(e);
+
+        return "[" + Ret + "]";
+    }
+
+    inline std::string SerializeUser(const User &u)
+    {
+        CJSON js;
+
+        js.AddPair("id", u->ID.load());
+        js.AddPair("username", u->Username.load());
+        js.AddPair("discriminator", u->Discriminator.load());
+        js.AddPair("avatar", u->Avatar.load());
+        js.AddPair("bot", u->Bot.load());
+        js.AddPair("public_flags", (int)u->PublicFlags);
+
+        return js.Serialize();
+    }
+
+    inline std::string SerializeRole(const Role &r)
+    {
+        CJSON js;
+
+        js.AddPair("id", r->ID.load());
+        js.AddPair("name", r->Name.load());
+        js.AddPair("color", r->Color.load());
+        js.AddPair("hoist", r->Hoist.load());
+        js.AddPair("position", r->Position.load());
+        js.AddPair("permissions", (uint32_t)r->Permissions);
+        js.AddPair("managed", r->Managed.load());
+        js.AddPair("mentionable", r->Mentionable.load());
+
+        return js.Serialize();
+    }
+
+    inline std::string SerializeChannel(const Channel &c)
+    {
+        CJSON js;
+
+        js.AddPair("id", c->ID.load());
+        js.AddPair("type", (int)c->Type);
+        js.AddPair("guild_id", c->GuildID.load());
+        js.AddPair("position", c->Position.load());
+        js.AddJSON("permission_overwrites", SerializeArray(c->Overwrites.load(), [](const PermissionOverwrites &ov)
+        {
+            CJSON jov;
+            jov.AddPair("id", ov->ID.load());
+            jov.AddPair("type", ov->Type.load());
+            jov.AddPair("allow", (int)ov->Allow);
+            jov.AddPair("deny", (int)ov->Deny);
+
+            return jov.Serialize();
+        }));
+        js.AddPair("name", c->Name.load());
+        js.AddPair("topic", c->Topic.load());
+        js.AddPair("nsfw", c->NSFW.load());
+        js.AddPair("last_message_id", c->LastMessageID.load());
+        js.AddPair("bitrate", c->Bitrate.load());
+        js.AddPair("user_limit", c->UserLimit.load());
+        js.AddPair("rate_limit_per_user", c->RateLimit.load());
+        js.AddPair("parent_id", c->ParentID.load());
+
+        return js.Serialize();
+    }
+
+    inline std::string SerializeMember(const GuildMember &m)
+    {
+        CJSON js;
+
+        if(m->UserRef)
+            js.AddJSON("user", SerializeUser(m->UserRef));
+
+        js.AddPair("nick", m->Nick.load());
+        js.AddPair("joined_at", m->JoinedAt.load());
+        js.AddPair("premium_since", m->PremiumSince.load());
+        js.AddPair("deaf", m->Deaf.load());
+        js.AddPair("mute", m->Mute.load());
+
+        std::vector<std::string> Roles;
+        for (auto &&e : m->Roles.load())
+            Roles.push_back(e->ID);
+
+        //Snowflakes only contain digits, so they don't need escaping.
+        js.AddJSON("roles", SerializeArray(Roles, [](const std::string &ID)
+        {
+            return "\"" + ID + "\"";
+        }));
+
+        return js.Serialize();
+    }
+
+    inline std::string SerializeVoiceState(const VoiceState &v)
+    {
+        CJSON js;
+
+        js.AddPair("guild_id", v->GuildRef ? v->GuildRef->ID.load() : std::string());
+        js.AddPair("channel_id", v->ChannelRef ? v->ChannelRef->ID.load() : std::string());
+        js.AddPair("user_id", v->UserRef ? v->UserRef->ID.load() : std::string());
+        js.AddPair("session_id", v->SessionID.load());
+        js.AddPair("deaf", v->Deaf.load());
+        js.AddPair("mute", v->Mute.load());
+        js.AddPair("self_deaf", v->SelfDeaf.load());
+        js.AddPair("self_mute", v->SelfMute.load());
+        js.AddPair("self_stream", v->SelfStream.load());
+        js.AddPair("suppress", v->Supress.load());
+
+        return js.Serialize();
+    }
+
+    /**
+     * @brief Serializes a guild with all cached roles, channels, members and voice states like a GUILD_CREATE event.
+     */
+    inline std::string SerializeGuild(const Guild &g)
+    {
+        CJSON js;
+
+        js.AddPair("id", g->ID.load());
+        js.AddPair("name", g->Name.load());
+        js.AddPair("icon", g->Icon.load());
+        js.AddPair("owner_id", g->OwnerID.load());
+        js.AddPair("large", false);
+
+        std::vector<Role> Roles;
+        for (auto &&e : g->Roles.load())
+            Roles.push_back(e.second);
+
+        std::vector<Channel> Channels;
+        for (auto &&e : g->Channels.load())
+            Channels.push_back(e.second);
+
+        std::vector<GuildMember> Members;
+        std::vector<VoiceState> States;
+        for (auto &&e : g->Members.load())
+        {
+            Members.push_back(e.second);
+            if(e.second->State)
+                States.push_back(e.second->State);
+        }
+
+        js.AddJSON("roles", SerializeArray(Roles, SerializeRole));
+        js.AddJSON("channels", SerializeArray(Channels, SerializeChannel));
+        js.AddJSON("members", SerializeArray(Members, SerializeMember));
+        js.AddJSON("voice_states", SerializeArray(States, SerializeVoiceState));
+
+        return js.Serialize();
+    }
+
     //--------------------------Abstract operators for json parsing--------------------------//
 
     /**
@@ -0,0 +1,207 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "JSONScanner.hpp"
+#include <string.h>
+
+namespace DiscordBot
+{
+    CJSONScanner::CJSONScanner(const std::string &Data, SJSONRange Range) : m_Data(Data), m_Pos(Range.Pos), m_End(Range.Pos + Range.Len), m_Started(false), m_Failed(false)
+    {
+        if(m_End > m_Data.size())
+            m_End = m_Data.size();
+    }
+
+    CJSONScanner::CJSONScanner(const std::string &Data) : m_Data(Data), m_Pos(0), m_End(Data.size()), m_Started(false), m_Failed(false) {}
+
+    bool CJSONScanner::Next(SJSONRange &Key, SJSONRange &Value)
+    {
+        if(m_Failed)
+            return false;
+
+        SkipWhitespaces();
+        if(!m_Started)
+        {
+            if(m_Pos >= m_End || m_Data[m_Pos] != '{')
+            {
+                m_Failed = true;
+                return false;
+            }
+
+            m_Started = true;
+            m_Pos++;
+            SkipWhitespaces();
+        }
+        else if(m_Pos < m_End && m_Data[m_Pos] == ',')
+        {
+            m_Pos++;
+            SkipWhitespaces();
+        }
+
+        if(m_Pos >= m_End)
+        {
+            m_Failed = true;
+            return false;
+        }
+
+        //End of the object.
+        if(m_Data[m_Pos] == '}')
+            return false;
+
+        size_t Beg = m_Pos;
+        if(m_Data[m_Pos] != '"' || !SkipString())
+        {
+            m_Failed = true;
+            return false;
+        }
+
+        Key.Pos = Beg + 1;
+        Key.Len = m_Pos - Beg - 2;
+
+        SkipWhitespaces();
+        if(m_Pos >= m_End || m_Data[m_Pos] != ':')
+        {
+            m_Failed = true;
+            return false;
+        }
+
+        m_Pos++;
+        SkipWhitespaces();
+
+        Beg = m_Pos;
+        if(!SkipValue())
+        {
+            m_Failed = true;
+            return false;
+        }
+
+        Value.Pos = Beg;
+        Value.Len = m_Pos - Beg;
+
+        SkipWhitespaces();
+        if(m_Pos >= m_End || (m_Data[m_Pos] != ',' && m_Data[m_Pos] != '}'))
+        {
+            m_Failed = true;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool CJSONScanner::Find(const std::string &Key, SJSONRange &Value)
+    {
+        SJSONRange Name;
+        while (Next(Name, Value))
+        {
+            if(Name.Len == Key.size() && m_Data.compare(Name.Pos, Name.Len, Key) == 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    bool CJSONScanner::IsKey(const SJSONRange &Key, const char *Name) const
+    {
+        size_t Len = strlen(Name);
+        return Key.Len == Len && m_Data.compare(Key.Pos, Key.Len, Name) == 0;
+    }
+
+    std::string CJSONScanner::GetString(const SJSONRange &Value) const
+    {
+        if(Value.Len >= 2 && m_Data[Value.Pos] == '"')
+            return m_Data.substr(Value.Pos + 1, Value.Len - 2);
+
+        return m_Data.substr(Value.Pos, Value.Len);
+    }
+
+    void CJSONScanner::SkipWhitespaces()
+    {
+        while (m_Pos < m_End && (m_Data[m_Pos] == ' ' || m_Data[m_Pos] == '\t' || m_Data[m_Pos] == '\r' || m_Data[m_Pos] == '\n'))
+            m_Pos++;
+    }
+
+    bool CJSONScanner::SkipString()
+    {
+        //Skips the opening quote.
+        m_Pos++;
+        while (m_Pos < m_End)
+        {
+            char c = m_Data[m_Pos++];
+            if(c == '\\')
+                m_Pos++;
+            else if(c == '"')
+                return m_Pos <= m_End;
+        }
+
+        return false;
+    }
+
+    bool CJSONScanner::SkipValue()
+    {
+        if(m_Pos >= m_End)
+            return false;
+
+        char c = m_Data[m_Pos];
+        if(c == '"')
+            return SkipString();
+        else if(c == '{' || c == '[')
+        {
+            //Only the brackets are counted, the content is validated by the parser of the value.
+            size_t Depth = 0;
+            while (m_Pos < m_End)
+            {
+                c = m_Data[m_Pos];
+                if(c == '"')
+                {
+                    if(!SkipString())
+                        return false;
+
+                    continue;
+                }
+                else if(c == '{' || c == '[')
+                    Depth++;
+                else if(c == '}' || c == ']')
+                {
+                    Depth--;
+                    if(Depth == 0)
+                    {
+                        m_Pos++;
+                        return true;
+                    }
+                }
+
+                m_Pos++;
+            }
+
+            return false;
+        }
+
+        //Numbers, booleans and null.
+        size_t Beg = m_Pos;
+        while (m_Pos < m_End && m_Data[m_Pos] != ',' && m_Data[m_Pos] != '}' && m_Data[m_Pos] != ']' && m_Data[m_Pos] != ' ' && m_Data[m_Pos] != '\t' && m_Data[m_Pos] != '\r' && m_Data[m_Pos] != '\n')
+            m_Pos++;
+
+        return m_Pos != Beg;
+    }
+} // namespace DiscordBot
@@ -0,0 +1,112 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef JSONSCANNER_HPP
+#define JSONSCANNER_HPP
+
+#include <string>
+#include <stddef.h>
+
+namespace DiscordBot
+{
+    /**
+     * @brief Position of a raw json value inside a message.
+     */
+    struct SJSONRange
+    {
+        SJSONRange() : Pos(0), Len(0) {}
+
+        size_t Pos;
+        size_t Len;
+    };
+
+    /**
+     * @brief Iterates the top level members of a json object without decoding or copying the values.
+     * 
+     * Nested objects and arrays are skipped, so the caller can decide which values are worth parsing.
+     */
+    class CJSONScanner
+    {
+        public:
+            /**
+             * @param Data: Message which contains the object.
+             * @param Range: Position of the object inside the message.
+             */
+            CJSONScanner(const std::string &Data, SJSONRange Range);
+
+            /**
+             * @param Data: Message which is the object.
+             */
+            CJSONScanner(const std::string &Data);
+
+            /**
+             * @brief Reads the next member of the object.
+             * 
+             * @param Key: Receives the range of the key without quotes.
+             * @param Value: Receives the range of the raw value. Strings include their quotes.
+             * 
+             * @return Returns false at the end of the object or if the json is invalid. See @ref Failed.
+             */
+            bool Next(SJSONRange &Key, SJSONRange &Value);
+
+            /**
+             * @brief Searches a member of the object, beginning at the current position.
+             * 
+             * @return Returns false if the key doesn't exist.
+             */
+            bool Find(const std::string &Key, SJSONRange &Value);
+
+            /**
+             * @return Returns true if the key range equals the given key.
+             */
+            bool IsKey(const SJSONRange &Key, const char *Name) const;
+
+            /**
+             * @return Returns true if the json is invalid.
+             */
+            bool Failed() const
+            {
+                return m_Failed;
+            }
+
+            /**
+             * @return Returns the raw value as string. Quotes of strings are removed, escape sequences are kept.
+             */
+            std::string GetString(const SJSONRange &Value) const;
+
+        private:
+            const std::string &m_Data;
+            size_t m_Pos;
+            size_t m_End;
+            bool m_Started;
+            bool m_Failed;
+
+            void SkipWhitespaces();
+            bool SkipString();
+            bool SkipValue();
+    };
+} // namespace DiscordBot
+
+
+#endif //JSONSCANNER_HPP
@@ -0,0 +1,125 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ZLibStream.hpp"
+#include <Log.hpp>
+#include <string.h>
+
+namespace DiscordBot
+{
+    const size_t CZLibStream::CHUNK_SIZE;
+
+    CZLibStream::CZLibStream() : m_Initialized(false), m_Chunk(CHUNK_SIZE)
+    {
+        Reset();
+    }
+
+    /**
+     * @brief Resets the inflate context. Must be called for every new connection.
+     */
+    void CZLibStream::Reset()
+    {
+        if(m_Initialized)
+            inflateEnd(&m_Stream);
+
+        memset(&m_Stream, 0, sizeof(m_Stream));
+        m_Stream.zalloc = Z_NULL;
+        m_Stream.zfree = Z_NULL;
+        m_Stream.opaque = Z_NULL;
+
+        m_Initialized = inflateInit(&m_Stream) == Z_OK;
+        if(!m_Initialized)
+            llog << lerror << "Failed to initialize the zlib stream." << lendl;
+
+        m_Input.clear();
+        m_Output.clear();
+    }
+
+    /**
+     * @brief Appends a websocket frame and inflates the buffered data, if the frame ends with the Z_SYNC_FLUSH suffix.
+     * 
+     * @param Frame: Binary websocket frame.
+     */
+    CZLibStream::Result CZLibStream::Feed(const std::string &Frame)
+    {
+        if(!m_Initialized)
+            return Result::FAILED;
+
+        //Avoids a copy for the common case, that a message fits into one frame.
+        const std::string *Data = &Frame;
+        if(!m_Input.empty() || !HasSyncFlushSuffix(Frame))
+        {
+            m_Input.append(Frame);
+            if(!HasSyncFlushSuffix(m_Input))
+                return Result::NEED_MORE;
+
+            Data = &m_Input;
+        }
+
+        //Keeps the capacity of the last message.
+        m_Output.clear();
+
+        m_Stream.next_in = (Bytef*)Data->data();
+        m_Stream.avail_in = (uInt)Data->size();
+
+        do
+        {
+            m_Stream.next_out = (Bytef*)m_Chunk.data();
+            m_Stream.avail_out = (uInt)m_Chunk.size();
+
+            int Ret = inflate(&m_Stream, Z_SYNC_FLUSH);
+            if(Ret != Z_OK && Ret != Z_BUF_ERROR)
+            {
+                llog << lerror << "Failed to inflate gateway message. zlib error: " << Ret << lendl;
+                m_Input.clear();
+                return Result::FAILED;
+            }
+
+            m_Output.append(m_Chunk.data(), m_Chunk.size() - m_Stream.avail_out);
+
+            //No progress possible.
+            if(Ret == Z_BUF_ERROR)
+                break;
+        } while (m_Stream.avail_in > 0 || m_Stream.avail_out == 0);
+
+        m_Input.clear();
+        return Result::OK;
+    }
+
+    bool CZLibStream::HasSyncFlushSuffix(const std::string &Data) const
+    {
+        static const char SUFFIX[] = {'\x00', '\x00', '\xFF', '\xFF'};
+
+        if(Data.size() < sizeof(SUFFIX))
+            return false;
+
+        return memcmp(Data.data() + Data.size() - sizeof(SUFFIX), SUFFIX, sizeof(SUFFIX)) == 0;
+    }
+
+    CZLibStream::~CZLibStream()
+    {
+        if(m_Initialized)
+            inflateEnd(&m_Stream);
+    }
+} // namespace DiscordBot
@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ZLIBSTREAM_HPP
+#define ZLIBSTREAM_HPP
+
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+namespace DiscordBot
+{
+    /**
+     * @brief Decompresses the "zlib-stream" transport compression of the discord gateway.
+     * 
+     * @note Discord uses one zlib context for the whole connection. So one instance of this class must be used per connection and must be reset, if the connection reopens.
+     */
+    class CZLibStream
+    {
+        public:
+            enum class Result
+            {
+                NEED_MORE,      //!< The frame is only a part of a message. Wait for the next frame.
+                OK,             //!< A complete message is inflated. @see GetMessage()
+                FAILED          //!< The stream is corrupt. The connection must be reopened.
+            };
+
+            CZLibStream();
+
+            /**
+             * @brief Resets the inflate context. Must be called for every new connection.
+             */
+            void Reset();
+
+            /**
+             * @brief Appends a websocket frame and inflates the buffered data, if the frame ends with the Z_SYNC_FLUSH suffix.
+             * 
+             * @param Frame: Binary websocket frame.
+             */
+            Result Feed(const std::string &Frame);
+
+            /**
+             * @return Returns the last inflated message. The buffer is reused and only valid until the next call of Feed.
+             */
+            inline const std::string &GetMessage() const
+            {
+                return m_Output;
+            }
+
+            ~CZLibStream();
+
+        private:
+            static const size_t CHUNK_SIZE = 64 * 1024;
+
+            z_stream m_Stream;
+            bool m_Initialized;
+
+            std::string m_Input;            //!< Reassembly buffer for messages which are splitted over multiple frames.
+            std::string m_Output;           //!< Reusable buffer for the inflated message.
+            std::vector<char> m_Chunk;
+
+            /**
+             * @return Returns true if the data ends with 0x00 0x00 0xFF 0xFF.
+             */
+            bool HasSyncFlushSuffix(const std::string &Data) const;
+    };
+} // namespace DiscordBot
+
+
+#endif //ZLIBSTREAM_HPP
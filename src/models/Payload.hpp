@@ -26,6 +26,8 @@
 #define PAYLOAD_HPP
 
 #include <JSON.hpp>
+#include <stdlib.h>
+#include "../helpers/JSONScanner.hpp"
 
 namespace DiscordBot
 {
@@ -85,6 +87,82 @@ namespace DiscordBot
             }
     };
 
+    /**
+     * @brief Envelope of a received payload. Only op, s and t are decoded, "d" is referenced by its position inside the message.
+     */
+    struct SEnvelope
+    {
+        public:
+            SEnvelope() : OP(0), S(0) {}
+
+            uint32_t OP;
+            uint32_t S;
+            std::string T;
+            SJSONRange D;
+
+            /**
+             * @brief Scans the top level of a message.
+             * 
+             * @return Returns false if the message isn't a valid payload.
+             */
+            bool Scan(const std::string &Data)
+            {
+                CJSONScanner Scanner(Data);
+                SJSONRange Key, Value;
+                bool HasOP = false;
+
+                while (Scanner.Next(Key, Value))
+                {
+                    if(Scanner.IsKey(Key, "op"))
+                    {
+                        OP = (uint32_t)strtoul(Data.c_str() + Value.Pos, nullptr, 10);
+                        HasOP = true;
+                    }
+                    else if(Scanner.IsKey(Key, "s"))
+                        S = (uint32_t)strtoul(Data.c_str() + Value.Pos, nullptr, 10);
+                    else if(Scanner.IsKey(Key, "t"))
+                        T = Data[Value.Pos] == '"' ? Scanner.GetString(Value) : "";
+                    else if(Scanner.IsKey(Key, "d"))
+                        D = Value;
+                }
+
+                return HasOP && !Scanner.Failed();
+            }
+
+            /**
+             * @return Returns true if "d" is exactly the given raw value.
+             */
+            bool IsD(const std::string &Data, const char *Val) const
+            {
+                return Data.compare(D.Pos, D.Len, Val) == 0;
+            }
+
+            /**
+             * @return Copies "d" out of the message. Null is returned as empty string.
+             */
+            std::string GetD(const std::string &Data) const
+            {
+                if(D.Len == 0 || IsD(Data, "null"))
+                    return "";
+
+                return Data.substr(D.Pos, D.Len);
+            }
+
+            /**
+             * @brief Creates a payload with a copy of "d". Only needed if the event outlives the message.
+             */
+            SPayload ToPayload(const std::string &Data) const
+            {
+                SPayload Ret;
+                Ret.OP = OP;
+                Ret.S = S;
+                Ret.T = T;
+                Ret.D = GetD(Data);
+
+                return Ret;
+            }
+    };
+
     /**
      * @brief Returns the name of a JSONErrorType enum value as string. Needed for logging.
      */
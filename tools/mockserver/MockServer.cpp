@@ -0,0 +1,521 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "MockServer.hpp"
+#include <Log.hpp>
+#include <thread>
+#include <chrono>
+#include <vector>
+
+namespace DiscordBot
+{
+    namespace
+    {
+        ix::HttpResponsePtr CreateResponse(int Status, const std::string &Description, const std::string &Body)
+        {
+            ix::WebSocketHttpHeaders Headers;
+            Headers["Content-Type"] = "application/json";
+
+            return std::make_shared<ix::HttpResponse>(Status, Description, ix::HttpErrorCode::Ok, Headers, Body);
+        }
+
+        uint64_t ParseSnowflake(const std::string &ID)
+        {
+            try
+            {
+                return std::stoull(ID);
+            }
+            catch (const std::exception &e)
+            {
+                return 0;
+            }
+        }
+
+        std::string Join(const std::vector<std::string> &Values)
+        {
+            std::string Ret = "[";
+            for (size_t i = 0; i < Values.size(); i++)
+                Ret += (i == 0 ? "" : ",") + Values[i];
+
+            return Ret + "]";
+        }
+    }
+
+    const uint32_t CMockServer::CHUNK_SIZE;
+    const uint64_t CMockServer::USER_OFFSET;
+    const char *CMockServer::BOT_ID = "1";
+
+    CMockServer::CMockServer(const SMockConfig &Config) : m_Config(Config), m_Gateway(Config.GatewayPort, Config.Host), m_HTTP(Config.HTTPPort, Config.Host), m_Quit(false), m_Requests(0), m_NextMessageID(0), m_NextSession(0)
+    {
+        m_Config.Shards = std::max<uint32_t>(m_Config.Shards, 1);
+        m_Config.Channels = std::max<uint32_t>(m_Config.Channels, 1);
+
+        m_Gateway.setOnClientMessageCallback(std::bind(&CMockServer::OnGatewayMessage, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        m_HTTP.setOnConnectionCallback(std::bind(&CMockServer::OnHTTPRequest, this, std::placeholders::_1, std::placeholders::_2));
+    }
+
+    void CMockServer::Run()
+    {
+        auto Res = m_Gateway.listen();
+        if(!Res.first)
+        {
+            llog << lerror << "Failed to start the gateway: " << Res.second << lendl;
+            return;
+        }
+
+        Res = m_HTTP.listen();
+        if(!Res.first)
+        {
+            llog << lerror << "Failed to start the REST server: " << Res.second << lendl;
+            return;
+        }
+
+        m_Gateway.start();
+        m_HTTP.start();
+        llog << linfo << "Mock server started. Gateway: ws://" << m_Config.Host << ":" << m_Config.GatewayPort << " REST: http://" << m_Config.Host << ":" << m_Config.HTTPPort << "/api" << lendl;
+
+        auto Start = std::chrono::steady_clock::now();
+        uint64_t Sent = 0;
+
+        //Runs until the server quits.
+        while (!m_Quit)
+        {
+            if(m_Config.EventRate != 0)
+            {
+                uint64_t Elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - Start).count();
+                uint64_t Due = Elapsed * m_Config.EventRate / 1000;
+
+                //Events which are more than one second late are dropped.
+                if(Due > Sent)
+                    GenerateEvents((uint32_t)std::min<uint64_t>(Due - Sent, m_Config.EventRate));
+
+                Sent = Due;
+            }
+
+            std::unique_lock<std::mutex> lock(m_Lock);
+            m_Signal.wait_for(lock, std::chrono::milliseconds(10));
+        }
+
+        m_Gateway.stop();
+        m_HTTP.stop();
+    }
+
+    void CMockServer::Quit()
+    {
+        m_Quit = true;
+        m_Signal.notify_all();
+    }
+
+    void CMockServer::OnGatewayMessage(std::shared_ptr<ix::ConnectionState> State, ix::WebSocket &Socket, const ix::WebSocketMessagePtr &msg)
+    {
+        switch (msg->type)
+        {
+            case ix::WebSocketMessageType::Open:
+            {
+                std::lock_guard<std::mutex> lock(m_Lock);
+                SConnection &Con = m_Connections[State->getId()];
+                Con.Socket = &Socket;
+
+                CJSON json;
+                json.AddPair("heartbeat_interval", m_Config.HeartbeatInterval);
+                Send(Con, 10, json.Serialize());
+            }break;
+
+            case ix::WebSocketMessageType::Close:
+            {
+                std::lock_guard<std::mutex> lock(m_Lock);
+                m_Connections.erase(State->getId());
+            }break;
+
+            case ix::WebSocketMessageType::Message:
+            {
+                try
+                {
+                    CJSON json;
+                    json.ParseObject(msg->str);
+
+                    std::lock_guard<std::mutex> lock(m_Lock);
+                    auto IT = m_Connections.find(State->getId());
+                    if(IT == m_Connections.end())
+                        return;
+
+                    SConnection &Con = IT->second;
+                    switch (json.GetValue<uint32_t>("op"))
+                    {
+                        //HEARTBEAT
+                        case 1:
+                        {
+                            Send(Con, 11, "");
+                        }break;
+
+                        //IDENTIFY
+                        case 2:
+                        {
+                            CJSON D;
+                            D.ParseObject(json.GetValue<std::string>("d"));
+                            OnIdentify(Con, D);
+                        }break;
+
+                        //RESUME, the missed events aren't replayed.
+                        case 6:
+                        {
+                            Con.Identified = true;
+                            SendDispatch(Con, "RESUMED", "{}");
+                        }break;
+
+                        //REQUEST_GUILD_MEMBERS
+                        case 8:
+                        {
+                            CJSON D;
+                            D.ParseObject(json.GetValue<std::string>("d"));
+                            OnRequestMembers(Con, D);
+                        }break;
+                    }
+                }
+                catch (const CJSONException &e)
+                {
+                    llog << lerror << "Failed to parse a gateway command what(): " << e.what() << lendl;
+                }
+            }break;
+
+            default:
+                break;
+        }
+    }
+
+    ix::HttpResponsePtr CMockServer::OnHTTPRequest(ix::HttpRequestPtr Req, std::shared_ptr<ix::ConnectionState> State)
+    {
+        if(m_Config.Latency != 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(m_Config.Latency));
+
+        if(m_Config.RateLimitEvery != 0 && (++m_Requests % m_Config.RateLimitEvery) == 0)
+        {
+            auto Res = CreateResponse(429, "Too Many Requests", "{\"message\":\"You are being rate limited.\",\"retry_after\":1,\"global\":false}");
+            Res->headers["Retry-After"] = "1";
+            Res->headers["X-RateLimit-Limit"] = "5";
+            Res->headers["X-RateLimit-Remaining"] = "0";
+            Res->headers["X-RateLimit-Reset-After"] = "1";
+
+            return Res;
+        }
+
+        std::string URI = Req->uri.substr(0, Req->uri.find('?'));
+        const std::string GUILDS = "/api/guilds/";
+        const std::string CHANNELS = "/api/channels/";
+        const std::string MESSAGES = "/messages";
+
+        if(Req->method == "GET" && URI == "/api/gateway/bot")
+        {
+            CJSON Limit;
+            Limit.AddPair("total", 1000);
+            Limit.AddPair("remaining", 1000);
+            Limit.AddPair("reset_after", 0);
+            Limit.AddPair("max_concurrency", 1);
+
+            CJSON json;
+            json.AddPair("url", "ws://" + m_Config.Host + ":" + std::to_string(m_Config.GatewayPort));
+            json.AddPair("shards", m_Config.Shards);
+            json.AddJSON("session_start_limit", Limit.Serialize());
+
+            return CreateResponse(200, "OK", json.Serialize());
+        }
+        else if(Req->method == "GET" && URI == "/api/users/@me")
+            return CreateResponse(200, "OK", CreateUser(BOT_ID, "MockBot"));
+        else if(Req->method == "GET" && URI.compare(0, GUILDS.size(), GUILDS) == 0 && URI.find("/members/") != std::string::npos)
+        {
+            std::string UserID = URI.substr(URI.find_last_of('/') + 1);
+            uint64_t Member = (ParseSnowflake(UserID) >> 22);
+
+            if(Member >= USER_OFFSET && Member - USER_OFFSET < m_Config.Members)
+                return CreateResponse(200, "OK", CreateMember((uint32_t)(Member - USER_OFFSET)));
+        }
+        else if(Req->method == "POST" && URI.compare(0, CHANNELS.size(), CHANNELS) == 0 && URI.size() > MESSAGES.size() && URI.compare(URI.size() - MESSAGES.size(), MESSAGES.size(), MESSAGES) == 0)
+        {
+            std::string ChannelID = URI.substr(CHANNELS.size(), URI.size() - CHANNELS.size() - MESSAGES.size());
+            uint64_t Guild = (ParseSnowflake(ChannelID) >> 22);
+
+            std::string Content;
+            try
+            {
+                CJSON json;
+                json.ParseObject(Req->body);
+                Content = json.GetValue<std::string>("content");
+            }
+            catch (const CJSONException &e)
+            {
+                return CreateResponse(400, "Bad Request", "{\"message\":\"400: Bad Request\",\"code\":0}");
+            }
+
+            if(Guild >= 1 && Guild <= m_Config.Guilds)
+                return CreateResponse(200, "OK", CreateMessage(ChannelID, GetGuildID((uint32_t)Guild - 1), CreateUser(BOT_ID, "MockBot"), Content));
+        }
+
+        return CreateResponse(404, "Not Found", "{\"message\":\"404: Not Found\",\"code\":0}");
+    }
+
+    void CMockServer::OnIdentify(SConnection &Con, CJSON &json)
+    {
+        std::vector<uint32_t> Shard = json.GetValue<std::vector<uint32_t>>("shard");
+        if(Shard.size() == 2 && Shard[1] != 0)
+        {
+            Con.ShardID = Shard[0];
+            Con.ShardCount = Shard[1];
+        }
+
+        Con.LargeThreshold = json.GetValue<uint32_t>("large_threshold");
+        if(Con.LargeThreshold == 0)
+            Con.LargeThreshold = 50;
+
+        Con.Identified = true;
+        Con.Seq = 0;
+
+        std::vector<std::string> Guilds;
+        for (uint32_t i = 0; i < m_Config.Guilds; i++)
+        {
+            if(GetShardID(i, Con.ShardCount) == Con.ShardID)
+                Guilds.push_back("{\"id\":\"" + GetGuildID(i) + "\",\"unavailable\":true}");
+        }
+
+        CJSON Ready;
+        Ready.AddPair("v", 8);
+        Ready.AddJSON("user", CreateUser(BOT_ID, "MockBot"));
+        Ready.AddJSON("guilds", Join(Guilds));
+        Ready.AddPair("session_id", "mock-" + std::to_string(++m_NextSession));
+        Ready.AddPair("resume_gateway_url", "ws://" + m_Config.Host + ":" + std::to_string(m_Config.GatewayPort));
+        Ready.AddPair("shard", std::vector<uint32_t>{Con.ShardID, Con.ShardCount});
+        SendDispatch(Con, "READY", Ready.Serialize());
+
+        for (uint32_t i = 0; i < m_Config.Guilds; i++)
+        {
+            if(GetShardID(i, Con.ShardCount) == Con.ShardID)
+                SendDispatch(Con, "GUILD_CREATE", CreateGuild(i, Con.LargeThreshold));
+        }
+    }
+
+    void CMockServer::OnRequestMembers(SConnection &Con, CJSON &json)
+    {
+        std::string GuildID = json.GetValue<std::string>("guild_id");
+        uint64_t Guild = (ParseSnowflake(GuildID) >> 22);
+        if(Guild < 1 || Guild > m_Config.Guilds)
+            return;
+
+        uint32_t Count = std::max<uint32_t>((m_Config.Members + CHUNK_SIZE - 1) / CHUNK_SIZE, 1);
+        for (uint32_t i = 0; i < Count; i++)
+        {
+            std::vector<std::string> Members;
+            for (uint32_t j = i * CHUNK_SIZE; j < std::min(m_Config.Members, (i + 1) * CHUNK_SIZE); j++)
+                Members.push_back(CreateMember(j));
+
+            CJSON Chunk;
+            Chunk.AddPair("guild_id", GuildID);
+            Chunk.AddJSON("members", Join(Members));
+            Chunk.AddPair("chunk_index", i);
+            Chunk.AddPair("chunk_count", Count);
+            Chunk.AddPair("nonce", json.GetValue<std::string>("nonce"));
+
+            SendDispatch(Con, "GUILD_MEMBERS_CHUNK", Chunk.Serialize());
+        }
+    }
+
+    void CMockServer::GenerateEvents(uint32_t Count)
+    {
+        if(m_Config.Guilds == 0 || m_Config.Members == 0)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_Lock);
+        for (auto &&e : m_Connections)
+        {
+            SConnection &Con = e.second;
+            if(!Con.Identified)
+                continue;
+
+            for (uint32_t i = 0; i < Count; i++)
+            {
+                //Searches the next guild of this shard.
+                uint32_t Guild = m_Config.Guilds;
+                for (uint32_t j = 0; j < m_Config.Guilds; j++)
+                {
+                    uint32_t Tmp = (Con.NextGuild++) % m_Config.Guilds;
+                    if(GetShardID(Tmp, Con.ShardCount) == Con.ShardID)
+                    {
+                        Guild = Tmp;
+                        break;
+                    }
+                }
+
+                if(Guild == m_Config.Guilds)
+                    break;
+
+                uint32_t Member = m_Random() % m_Config.Members;
+                std::string Channel = GetChannelID(Guild, m_Random() % m_Config.Channels);
+
+                SendDispatch(Con, "MESSAGE_CREATE", CreateMessage(Channel, GetGuildID(Guild), CreateUser(GetUserID(Member), "User" + std::to_string(Member)), "!ping"));
+            }
+        }
+    }
+
+    void CMockServer::Send(SConnection &Con, uint32_t OP, const std::string &Data)
+    {
+        CJSON json;
+        json.AddPair("op", OP);
+        if(Data.empty())
+            json.AddPair("d", nullptr);
+        else
+            json.AddJSON("d", Data);
+
+        json.AddPair("s", nullptr);
+        json.AddPair("t", nullptr);
+
+        Con.Socket->send(json.Serialize());
+    }
+
+    void CMockServer::SendDispatch(SConnection &Con, const std::string &Event, const std::string &Data)
+    {
+        CJSON json;
+        json.AddPair("op", 0);
+        json.AddJSON("d", Data);
+        json.AddPair("s", ++Con.Seq);
+        json.AddPair("t", Event);
+
+        Con.Socket->send(json.Serialize());
+    }
+
+    std::string CMockServer::GetGuildID(uint32_t Guild)
+    {
+        return std::to_string((uint64_t)(Guild + 1) << 22);
+    }
+
+    std::string CMockServer::GetChannelID(uint32_t Guild, uint32_t Channel)
+    {
+        return std::to_string(((uint64_t)(Guild + 1) << 22) + Channel + 1);
+    }
+
+    std::string CMockServer::GetUserID(uint32_t Member)
+    {
+        return std::to_string((uint64_t)(Member + USER_OFFSET) << 22);
+    }
+
+    uint32_t CMockServer::GetShardID(uint32_t Guild, uint32_t ShardCount)
+    {
+        //Same as (guild_id >> 22) % num_shards.
+        return (Guild + 1) % std::max<uint32_t>(ShardCount, 1);
+    }
+
+    std::string CMockServer::CreateUser(const std::string &ID, const std::string &Name)
+    {
+        CJSON json;
+        json.AddPair("id", ID);
+        json.AddPair("username", Name);
+        json.AddPair("discriminator", std::string("0001"));
+        json.AddPair("avatar", nullptr);
+        json.AddPair("bot", ID == BOT_ID);
+
+        return json.Serialize();
+    }
+
+    std::string CMockServer::CreateMember(uint32_t Member)
+    {
+        CJSON json;
+        json.AddJSON("user", CreateUser(GetUserID(Member), "User" + std::to_string(Member)));
+        json.AddJSON("roles", "[]");
+        json.AddPair("joined_at", std::string("2020-01-01T00:00:00.000000+00:00"));
+        json.AddPair("deaf", false);
+        json.AddPair("mute", false);
+
+        return json.Serialize();
+    }
+
+    std::string CMockServer::CreateGuild(uint32_t Guild, uint32_t LargeThreshold)
+    {
+        std::string GuildID = GetGuildID(Guild);
+
+        CJSON Everyone;
+        Everyone.AddPair("id", GuildID);
+        Everyone.AddPair("name", std::string("@everyone"));
+        Everyone.AddPair("permissions", 104324673);
+        Everyone.AddPair("position", 0);
+
+        std::vector<std::string> Channels;
+        for (uint32_t i = 0; i < m_Config.Channels; i++)
+        {
+            CJSON Channel;
+            Channel.AddPair("id", GetChannelID(Guild, i));
+            Channel.AddPair("type", 0);
+            Channel.AddPair("name", "channel-" + std::to_string(i));
+            Channel.AddPair("position", i);
+            Channel.AddJSON("permission_overwrites", "[]");
+
+            Channels.push_back(Channel.Serialize());
+        }
+
+        //Large guilds only contain the "online" members.
+        bool Large = m_Config.Members > LargeThreshold;
+        uint32_t Count = Large ? LargeThreshold : m_Config.Members;
+
+        CJSON BotMember;
+        BotMember.AddJSON("user", CreateUser(BOT_ID, "MockBot"));
+        BotMember.AddJSON("roles", "[]");
+        BotMember.AddPair("joined_at", std::string("2020-01-01T00:00:00.000000+00:00"));
+
+        std::vector<std::string> Members = {BotMember.Serialize()};
+        for (uint32_t i = 0; i < Count; i++)
+            Members.push_back(CreateMember(i));
+
+        CJSON json;
+        json.AddPair("id", GuildID);
+        json.AddPair("name", "Guild " + std::to_string(Guild));
+        json.AddPair("icon", nullptr);
+        json.AddPair("owner_id", m_Config.Members != 0 ? GetUserID(0) : std::string(BOT_ID));
+        json.AddPair("large", Large);
+        json.AddPair("member_count", m_Config.Members + 1);
+        json.AddJSON("roles", "[" + Everyone.Serialize() + "]");
+        json.AddJSON("channels", Join(Channels));
+        json.AddJSON("members", Join(Members));
+        json.AddJSON("voice_states", "[]");
+        json.AddJSON("presences", "[]");
+
+        return json.Serialize();
+    }
+
+    std::string CMockServer::CreateMessage(const std::string &ChannelID, const std::string &GuildID, const std::string &Author, const std::string &Content)
+    {
+        CJSON json;
+        json.AddPair("id", std::to_string(++m_NextMessageID << 22));
+        json.AddPair("channel_id", ChannelID);
+        json.AddPair("guild_id", GuildID);
+        json.AddJSON("author", Author);
+        json.AddPair("content", Content);
+        json.AddPair("timestamp", std::string("2020-01-01T00:00:00.000000+00:00"));
+        json.AddPair("edited_timestamp", nullptr);
+        json.AddPair("tts", false);
+        json.AddPair("mention_everyone", false);
+        json.AddJSON("mentions", "[]");
+        json.AddJSON("mention_roles", "[]");
+        json.AddJSON("attachments", "[]");
+        json.AddJSON("embeds", "[]");
+        json.AddPair("type", 0);
+
+        return json.Serialize();
+    }
+} // namespace DiscordBot
@@ -0,0 +1,137 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MOCKSERVER_HPP
+#define MOCKSERVER_HPP
+
+#include <ixwebsocket/IXWebSocketServer.h>
+#include <ixwebsocket/IXHttpServer.h>
+#include <JSON.hpp>
+#include <string>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <random>
+#include <stdint.h>
+
+namespace DiscordBot
+{
+    /**
+     * @brief Settings of the mock server.
+     */
+    struct SMockConfig
+    {
+        SMockConfig() : Host("127.0.0.1"), GatewayPort(8080), HTTPPort(8081), Shards(1), Guilds(10), Members(100), Channels(5), EventRate(0), Latency(0), RateLimitEvery(0), HeartbeatInterval(41250) {}
+
+        std::string Host;
+        int GatewayPort;
+        int HTTPPort;
+        uint32_t Shards;                //!< Recommended shard count of "/gateway/bot".
+        uint32_t Guilds;                //!< Total count of guilds.
+        uint32_t Members;               //!< Members per guild.
+        uint32_t Channels;              //!< Text channels per guild.
+        uint32_t EventRate;             //!< MESSAGE_CREATE events per second and connection.
+        uint32_t Latency;               //!< Delay of each REST response in milliseconds.
+        uint32_t RateLimitEvery;        //!< Every n-th REST request is answered with 429, 0 to disable.
+        uint32_t HeartbeatInterval;
+    };
+
+    /**
+     * @brief Local stand-in for the Discord gateway and REST api. Simulates guilds, members and message traffic to load test the client without a network.
+     * 
+     * Supported gateway opcodes: HEARTBEAT, IDENTIFY, RESUME, REQUEST_GUILD_MEMBERS. Only the json encoding without compression is supported.
+     * Supported REST routes: GET /api/gateway/bot, GET /api/users/@me, GET /api/guilds/{id}/members/{id}, POST /api/channels/{id}/messages.
+     */
+    class CMockServer
+    {
+        public:
+            CMockServer(const SMockConfig &Config);
+
+            /**
+             * @brief Runs the server. The call returns if you calls Quit().
+             */
+            void Run();
+            void Quit();
+
+        private:
+            static const uint32_t CHUNK_SIZE = 1000;     //!< Members per GUILD_MEMBERS_CHUNK event.
+            static const uint64_t USER_OFFSET = 1000;    //!< Offset of the user ids, so they don't overlap with the guild ids.
+            static const char *BOT_ID;
+
+            struct SConnection
+            {
+                SConnection() : Socket(nullptr), ShardID(0), ShardCount(1), LargeThreshold(50), Identified(false), Seq(0), NextGuild(0) {}
+
+                ix::WebSocket *Socket;
+                uint32_t ShardID;
+                uint32_t ShardCount;
+                uint32_t LargeThreshold;
+                bool Identified;
+                uint32_t Seq;
+                uint32_t NextGuild;     //!< Guild of the next generated event.
+            };
+
+            SMockConfig m_Config;
+            ix::WebSocketServer m_Gateway;
+            ix::HttpServer m_HTTP;
+
+            std::mutex m_Lock;
+            std::condition_variable m_Signal;
+            std::atomic<bool> m_Quit;
+
+            std::map<std::string, SConnection> m_Connections;
+            std::atomic<uint64_t> m_Requests;
+            std::atomic<uint64_t> m_NextMessageID;
+            uint64_t m_NextSession;
+            std::minstd_rand m_Random;
+
+            void OnGatewayMessage(std::shared_ptr<ix::ConnectionState> State, ix::WebSocket &Socket, const ix::WebSocketMessagePtr &msg);
+            ix::HttpResponsePtr OnHTTPRequest(ix::HttpRequestPtr Req, std::shared_ptr<ix::ConnectionState> State);
+
+            void OnIdentify(SConnection &Con, CJSON &json);
+            void OnRequestMembers(SConnection &Con, CJSON &json);
+
+            /**
+             * @brief Sends the generated MESSAGE_CREATE events.
+             */
+            void GenerateEvents(uint32_t Count);
+
+            void Send(SConnection &Con, uint32_t OP, const std::string &Data);
+            void SendDispatch(SConnection &Con, const std::string &Event, const std::string &Data);
+
+            std::string GetGuildID(uint32_t Guild);
+            std::string GetChannelID(uint32_t Guild, uint32_t Channel);
+            std::string GetUserID(uint32_t Member);
+            uint32_t GetShardID(uint32_t Guild, uint32_t ShardCount);
+
+            std::string CreateUser(const std::string &ID, const std::string &Name);
+            std::string CreateMember(uint32_t Member);
+            std::string CreateGuild(uint32_t Guild, uint32_t LargeThreshold);
+            std::string CreateMessage(const std::string &ChannelID, const std::string &GuildID, const std::string &Author, const std::string &Content);
+    };
+} // namespace DiscordBot
+
+
+#endif //MOCKSERVER_HPP
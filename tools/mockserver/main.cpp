@@ -0,0 +1,143 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Christian Tost
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "MockServer.hpp"
+#include <ixwebsocket/IXNetSystem.h>
+#include <iostream>
+#include <cstring>
+#include <cctype>
+#include <cstdint>
+#include <stdexcept>
+
+using namespace DiscordBot;
+
+void PrintUsage()
+{
+    std::cout << "Usage: mockserver [options]" << std::endl
+              << "  --host <ip>             Listen address. Default 127.0.0.1" << std::endl
+              << "  --gateway-port <port>   Port of the gateway. Default 8080" << std::endl
+              << "  --http-port <port>      Port of the REST api. Default 8081" << std::endl
+              << "  --shards <n>            Recommended shard count. Default 1" << std::endl
+              << "  --guilds <n>            Count of guilds. Default 10" << std::endl
+              << "  --members <n>           Members per guild. Default 100" << std::endl
+              << "  --channels <n>          Text channels per guild. Default 5" << std::endl
+              << "  --rate <n>              MESSAGE_CREATE events per second and connection. Default 0" << std::endl
+              << "  --latency <ms>          Delay of each REST response. Default 0" << std::endl
+              << "  --ratelimit <n>         Answers every n-th REST request with 429. Default 0 (disabled)" << std::endl
+              << std::endl
+              << "Client setup:" << std::endl
+              << "  client->SetBaseURL(\"http://127.0.0.1:8081/api\");" << std::endl;
+}
+
+/**
+ * @brief Parses a decimal number between 0 and Max.
+ * 
+ * @throws std::invalid_argument If the value contains anything else than digits.
+ * @throws std::out_of_range If the value is greater than Max.
+ */
+uint32_t ParseNumber(const std::string &Val, uint32_t Max)
+{
+    if(Val.empty())
+        throw std::invalid_argument("empty value");
+
+    for (auto &&c : Val)
+    {
+        if(!isdigit(static_cast<unsigned char>(c)))
+            throw std::invalid_argument("not a number");
+    }
+
+    unsigned long Ret = std::stoul(Val);
+    if(Ret > Max)
+        throw std::out_of_range("value too large");
+
+    return (uint32_t)Ret;
+}
+
+int main(int argc, char const *argv[])
+{
+    SMockConfig Config;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--help") == 0)
+        {
+            PrintUsage();
+            return 0;
+        }
+
+        std::string Arg = argv[i];
+        if(i + 1 >= argc)
+        {
+            std::cerr << "Missing value for " << Arg << std::endl;
+            PrintUsage();
+            return 1;
+        }
+
+        std::string Val = argv[++i];
+
+        try
+        {
+            if(Arg == "--host")
+                Config.Host = Val;
+            else if(Arg == "--gateway-port")
+                Config.GatewayPort = (int)ParseNumber(Val, UINT16_MAX);
+            else if(Arg == "--http-port")
+                Config.HTTPPort = (int)ParseNumber(Val, UINT16_MAX);
+            else if(Arg == "--shards")
+                Config.Shards = ParseNumber(Val, UINT32_MAX);
+            else if(Arg == "--guilds")
+                Config.Guilds = ParseNumber(Val, UINT32_MAX);
+            else if(Arg == "--members")
+                Config.Members = ParseNumber(Val, UINT32_MAX);
+            else if(Arg == "--channels")
+                Config.Channels = ParseNumber(Val, UINT32_MAX);
+            else if(Arg == "--rate")
+                Config.EventRate = ParseNumber(Val, UINT32_MAX);
+            else if(Arg == "--latency")
+                Config.Latency = ParseNumber(Val, UINT32_MAX);
+            else if(Arg == "--ratelimit")
+                Config.RateLimitEvery = ParseNumber(Val, UINT32_MAX);
+            else
+            {
+                std::cerr << "Unknown option " << Arg << std::endl;
+                PrintUsage();
+                return 1;
+            }
+        }
+        catch (const std::exception &)
+        {
+            std::cerr << "Invalid value for " << Arg << ": " << Val << std::endl;
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    //Needed for windows.
+    ix::initNetSystem();
+
+    CMockServer Server(Config);
+    Server.Run();
+
+    return 0;
+}